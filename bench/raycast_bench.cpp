@@ -0,0 +1,69 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "io.h"
+#include "solidity_grid.h"
+
+// Measures how many tile grid raycasts and line of sight checks per second the DDA walker manages on jungle.map.
+int main(int argc, char* argv[])
+{
+    const int ray_count = argc > 1 ? atoi(argv[1]) : 1000000;
+    const int tile_size = 32;
+
+    // Build the solidity grid the same way game::load_level does.
+    engine::physics::solidity_grid grid;
+    grid.load_tiles(engine::io::read_tile_map("./assets/tilemaps/jungle.map"), tile_size, engine::physics::JUNGLE_BLOCKING_TILES);
+    const int map_width = grid.get_width();
+    const int map_height = grid.get_height();
+
+    // Random rays starting anywhere on land, pointing anywhere.
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> x_distribution(0.0f, static_cast<float>(map_width * tile_size));
+    std::uniform_real_distribution<float> y_distribution(0.0f, static_cast<float>(map_height * tile_size));
+    std::uniform_real_distribution<float> angle_distribution(0.0f, 6.28318530718f);
+    auto random_land_point = [&]()
+    {
+        glm::vec2 point;
+        do
+        {
+            point = glm::vec2(x_distribution(random), y_distribution(random));
+        } while (grid.is_solid(static_cast<int>(point.x) / tile_size, static_cast<int>(point.y) / tile_size));
+        return point;
+    };
+
+    std::vector<engine::physics::ray> rays(ray_count);
+    std::vector<glm::vec2> from(ray_count);
+    std::vector<glm::vec2> to(ray_count);
+    for (int i = 0; i < ray_count; i++)
+    {
+        const float angle = angle_distribution(random);
+        rays[i].origin = random_land_point();
+        rays[i].direction = glm::vec2(std::cos(angle), std::sin(angle));
+        rays[i].max_distance = 1024.0f;
+        from[i] = rays[i].origin;
+        to[i] = random_land_point();
+    }
+
+    std::vector<engine::physics::raycast_hit> hits;
+    std::vector<bool> results;
+    auto start = std::chrono::steady_clock::now();
+    const int hit_count = grid.raycast_batch(rays, hits, results);
+    const double raycast_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<bool> visible;
+    start = std::chrono::steady_clock::now();
+    const int visible_count = grid.line_of_sight_batch(from, to, visible);
+    const double line_of_sight_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Grid: " << grid.get_width() << "x" << grid.get_height() << " tiles" << std::endl;
+    std::cout << "Raycasts: " << ray_count << " rays, " << hit_count << " hits, "
+        << static_cast<long long>(ray_count / raycast_seconds) << " rays/second" << std::endl;
+    std::cout << "Line of sight: " << ray_count << " checks, " << visible_count << " visible, "
+        << static_cast<long long>(ray_count / line_of_sight_seconds) << " checks/second" << std::endl;
+
+    return 0;
+}
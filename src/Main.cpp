@@ -1,9 +1,38 @@
+#include <cstdlib>
+#include <string>
 #include "game.h"
 
 int main(int argc, char* argv[])
 {
     engine::game game;
 
+    // --headless runs without a display, --threaded simulates on its own thread, --deterministic simulates with
+    // fixed point math, --frames N stops after N frames and --fps N sets the frame rate.
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string argument = argv[i];
+        if (argument == "--headless")
+        {
+            game.headless = true;
+        }
+        else if (argument == "--threaded")
+        {
+            game.threaded_simulation = true;
+        }
+        else if (argument == "--deterministic")
+        {
+            game.deterministic = true;
+        }
+        else if (argument == "--frames" && i + 1 < argc)
+        {
+            game.max_frames = std::atoi(argv[++i]);
+        }
+        else if (argument == "--fps" && i + 1 < argc)
+        {
+            game.target_fps = std::atoi(argv[++i]);
+        }
+    }
+
     game.initialize();
     game.run();
     game.destroy();
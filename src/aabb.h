@@ -0,0 +1,152 @@
+#ifndef ENGINE_AABB_H
+#define ENGINE_AABB_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <glm/common.hpp>
+#include <glm/vec2.hpp>
+
+namespace engine::physics
+{
+    /**
+     * Axis aligned bounding box in world space.
+     */
+    struct aabb
+    {
+        glm::vec2 min;
+        glm::vec2 max;
+
+        aabb(glm::vec2 min = glm::vec2(0.0, 0.0), glm::vec2 max = glm::vec2(0.0, 0.0))
+        {
+            this->min = min;
+            this->max = max;
+        }
+
+        // Boxes that only touch along an edge don't count as overlapping.
+        bool overlaps(const aabb& other) const
+        {
+            return min.x < other.max.x && max.x > other.min.x &&
+                min.y < other.max.y && max.y > other.min.y;
+        }
+
+        bool contains(const glm::vec2& point) const
+        {
+            return point.x >= min.x && point.x <= max.x && point.y >= min.y && point.y <= max.y;
+        }
+
+        glm::vec2 get_center() const { return (min + max) * 0.5f; }
+        glm::vec2 get_size() const { return max - min; }
+
+        // Half the perimeter. Used in place of surface area when estimating the cost of splitting boxes in 2D.
+        float get_half_perimeter() const { return (max.x - min.x) + (max.y - min.y); }
+
+        // Box grown by the given half extents on every side.
+        aabb inflated(const glm::vec2& extents) const
+        {
+            return aabb(min - extents, max + extents);
+        }
+
+        void expand(const aabb& other)
+        {
+            min = glm::min(min, other.min);
+            max = glm::max(max, other.max);
+        }
+
+        void expand(const glm::vec2& point)
+        {
+            min = glm::min(min, point);
+            max = glm::max(max, point);
+        }
+
+        /**
+         * Slab test against a ray, with the reciprocal of the ray direction precomputed by the caller.
+         * On a hit, distance is set to how far along the ray it enters the box (zero if it starts inside).
+         * A zero direction component gives an infinite reciprocal; that axis then only checks that the origin lies
+         * within the slab, since multiplying it out would give NaN for an origin on a face.
+         */
+        bool intersect_ray(const glm::vec2& origin, const glm::vec2& inverse_direction, float max_distance, float& distance) const
+        {
+            float t_enter = 0.0f;
+            float t_exit = max_distance;
+            if (!clip_slab(min.x, max.x, origin.x, inverse_direction.x, t_enter, t_exit) ||
+                !clip_slab(min.y, max.y, origin.y, inverse_direction.y, t_enter, t_exit))
+            {
+                return false;
+            }
+
+            distance = t_enter;
+            return true;
+        }
+
+    private:
+        // Narrows [t_enter, t_exit] to where the ray is between low and high on one axis.
+        static bool clip_slab(float low, float high, float origin, float inverse_direction, float& t_enter, float& t_exit)
+        {
+            if (std::isinf(inverse_direction))
+            {
+                return origin >= low && origin <= high;
+            }
+
+            const float t1 = (low - origin) * inverse_direction;
+            const float t2 = (high - origin) * inverse_direction;
+            t_enter = std::max(t_enter, std::min(t1, t2));
+            t_exit = std::min(t_exit, std::max(t1, t2));
+            return t_enter <= t_exit;
+        }
+    };
+
+    /**
+     * Result of a raycast. Item is the index of the box hit, if the query works on a set of boxes.
+     */
+    struct raycast_hit
+    {
+        int item = -1;
+        float distance = 0.0f;
+        glm::vec2 point = glm::vec2(0.0, 0.0);
+        glm::vec2 normal = glm::vec2(0.0, 0.0);
+    };
+
+    // Reciprocal of a ray direction for aabb::intersect_ray, with zero components mapped to infinity explicitly.
+    inline glm::vec2 get_inverse_direction(const glm::vec2& direction)
+    {
+        const float infinity = std::numeric_limits<float>::infinity();
+        return glm::vec2(
+            direction.x != 0.0f ? 1.0f / direction.x : infinity,
+            direction.y != 0.0f ? 1.0f / direction.y : infinity);
+    }
+
+    // Normal of the face of a box that a ray enters through.
+    inline glm::vec2 get_ray_entry_normal(const aabb& box, const glm::vec2& origin, const glm::vec2& direction)
+    {
+        const float tx = direction.x != 0.0f ? ((direction.x > 0.0f ? box.min.x : box.max.x) - origin.x) / direction.x : -1.0f;
+        const float ty = direction.y != 0.0f ? ((direction.y > 0.0f ? box.min.y : box.max.y) - origin.y) / direction.y : -1.0f;
+        return tx > ty
+            ? glm::vec2(direction.x > 0.0f ? -1.0f : 1.0f, 0.0f)
+            : glm::vec2(0.0f, direction.y > 0.0f ? -1.0f : 1.0f);
+    }
+
+    /**
+     * Sweeps a moving box by delta against a stationary one.
+     * On a hit, the distance is the time of impact from 0 to 1 and the point is the moving box's center at that time.
+     */
+    inline bool sweep_aabb(const aabb& moving, const glm::vec2& delta, const aabb& target, raycast_hit& hit)
+    {
+        const glm::vec2 origin = moving.get_center();
+        const aabb expanded = target.inflated(moving.get_size() * 0.5f);
+        const glm::vec2 inverse_delta = get_inverse_direction(delta);
+
+        float distance;
+        if (!expanded.intersect_ray(origin, inverse_delta, 1.0f, distance))
+        {
+            return false;
+        }
+
+        hit.distance = distance;
+        hit.point = origin + delta * distance;
+        hit.normal = get_ray_entry_normal(expanded, origin, delta);
+        return true;
+    }
+}
+
+#endif
@@ -0,0 +1,45 @@
+#include <vector>
+#include <SDL2/SDL.h>
+#include "animation.h"
+
+// Adds a clip playing the given frames in order and returns its index.
+int engine::animation_library::add_clip(const std::vector<SDL_Rect>& frames, float frames_per_second, bool loops)
+{
+    animation_clip clip;
+    clip.first_frame = static_cast<int>(_frames.size());
+    clip.frame_count = static_cast<int>(frames.size());
+    clip.frame_duration = frames_per_second > 0.0f ? 1.0f / frames_per_second : 1.0f;
+    clip.loops = loops;
+
+    _frames.insert(_frames.end(), frames.begin(), frames.end());
+    _clips.push_back(clip);
+    return static_cast<int>(_clips.size()) - 1;
+}
+
+// Adds a clip of equally sized frames laid out left to right on a sprite sheet, starting at (x, y).
+int engine::animation_library::add_strip(int x, int y, int frame_width, int frame_height, int frame_count, float frames_per_second, bool loops)
+{
+    std::vector<SDL_Rect> frames;
+    for (int i = 0; i < frame_count; i++)
+    {
+        frames.push_back({ x + i * frame_width, y, frame_width, frame_height });
+    }
+
+    return add_clip(frames, frames_per_second, loops);
+}
+
+int engine::animation_library::get_clip_count() const
+{
+    return static_cast<int>(_clips.size());
+}
+
+const engine::animation_clip& engine::animation_library::get_clip(int clip) const
+{
+    return _clips[clip];
+}
+
+// Frame rectangle at an index of the shared frame table, i.e. a clip's first frame plus the frame number.
+const SDL_Rect& engine::animation_library::get_frame(int index) const
+{
+    return _frames[index];
+}
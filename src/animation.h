@@ -0,0 +1,43 @@
+#ifndef ENGINE_ANIMATION_H
+#define ENGINE_ANIMATION_H
+
+#include <vector>
+#include <SDL2/SDL.h>
+
+namespace engine
+{
+    /**
+     * Run of frames in an animation library's frame table, played at a fixed rate.
+     */
+    struct animation_clip
+    {
+        int first_frame;
+        int frame_count;
+        float frame_duration;
+        bool loops;
+    };
+
+    /**
+     * Frame rectangles of every animation clip, precomputed into one contiguous table and shared by every entity
+     * playing them. Rectangles are relative to the sprite's image, like sprite_component::src_rect.
+     */
+    class animation_library
+    {
+        private:
+            std::vector<SDL_Rect> _frames;
+            std::vector<animation_clip> _clips;
+
+        public:
+            animation_library() = default;
+            ~animation_library() = default;
+
+            int add_clip(const std::vector<SDL_Rect>& frames, float frames_per_second, bool loops = true);
+            int add_strip(int x, int y, int frame_width, int frame_height, int frame_count, float frames_per_second, bool loops = true);
+
+            int get_clip_count() const;
+            const animation_clip& get_clip(int clip) const;
+            const SDL_Rect& get_frame(int index) const;
+    };
+}
+
+#endif
@@ -0,0 +1,321 @@
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include "bvh.h"
+
+bool engine::physics::bvh::is_empty() const
+{
+    return _nodes.empty();
+}
+
+int engine::physics::bvh::get_node_count() const
+{
+    return static_cast<int>(_nodes.size());
+}
+
+const std::vector<engine::physics::aabb>& engine::physics::bvh::get_boxes() const
+{
+    return _boxes;
+}
+
+// Builds the hierarchy from scratch. Item IDs are indices into boxes.
+void engine::physics::bvh::build(const std::vector<aabb>& boxes)
+{
+    _boxes = boxes;
+    _nodes.clear();
+    _items.resize(_boxes.size());
+    for (int i = 0; i < static_cast<int>(_items.size()); i++)
+    {
+        _items[i] = i;
+    }
+
+    if (_boxes.empty())
+    {
+        return;
+    }
+
+    // A binary tree over n leaves never needs more than 2n - 1 nodes.
+    _nodes.reserve(_boxes.size() * 2);
+    _nodes.push_back({ aabb(), 0, static_cast<int>(_boxes.size()) });
+    update_bounds(_nodes[0]);
+    subdivide(0, 0);
+    _nodes.shrink_to_fit();
+}
+
+void engine::physics::bvh::update_bounds(bvh_node& node) const
+{
+    node.bounds = _boxes[_items[node.first]];
+    for (int i = node.first + 1; i < node.first + node.count; i++)
+    {
+        node.bounds.expand(_boxes[_items[i]]);
+    }
+}
+
+/**
+ * Splits a leaf in two if the surface area heuristic says it's worth it.
+ * Item centroids are sorted into a few bins per axis and every boundary between bins is tried as a split plane.
+ */
+void engine::physics::bvh::subdivide(int node_index, int depth)
+{
+    const bvh_node node = _nodes[node_index];
+    if (node.count <= 1 || depth >= MAX_DEPTH)
+    {
+        return;
+    }
+
+    // Bounds of the item centroids, which is what the bins cover.
+    aabb centroid_bounds(_boxes[_items[node.first]].get_center(), _boxes[_items[node.first]].get_center());
+    for (int i = node.first + 1; i < node.first + node.count; i++)
+    {
+        centroid_bounds.expand(_boxes[_items[i]].get_center());
+    }
+
+    int best_axis = -1;
+    float best_split = 0.0f;
+    float best_cost = std::numeric_limits<float>::max();
+    for (int axis = 0; axis < 2; axis++)
+    {
+        const float bounds_min = centroid_bounds.min[axis];
+        const float bounds_max = centroid_bounds.max[axis];
+        if (bounds_max <= bounds_min)
+        {
+            continue;
+        }
+
+        struct bin
+        {
+            aabb bounds;
+            int count = 0;
+        };
+        bin bins[BIN_COUNT];
+
+        const float scale = BIN_COUNT / (bounds_max - bounds_min);
+        for (int i = node.first; i < node.first + node.count; i++)
+        {
+            const aabb& box = _boxes[_items[i]];
+            const int index = std::min(BIN_COUNT - 1, static_cast<int>((box.get_center()[axis] - bounds_min) * scale));
+            if (bins[index].count == 0)
+            {
+                bins[index].bounds = box;
+            }
+            else
+            {
+                bins[index].bounds.expand(box);
+            }
+            bins[index].count++;
+        }
+
+        // Sweep from both sides to get the cost of each of the BIN_COUNT - 1 split planes.
+        float left_area[BIN_COUNT - 1], right_area[BIN_COUNT - 1];
+        int left_count[BIN_COUNT - 1], right_count[BIN_COUNT - 1];
+        aabb left_bounds, right_bounds;
+        int left_sum = 0, right_sum = 0;
+        for (int i = 0; i < BIN_COUNT - 1; i++)
+        {
+            if (bins[i].count > 0)
+            {
+                left_bounds = left_sum == 0 ? bins[i].bounds : left_bounds;
+                left_bounds.expand(bins[i].bounds);
+                left_sum += bins[i].count;
+            }
+            left_count[i] = left_sum;
+            left_area[i] = left_bounds.get_half_perimeter();
+
+            const int j = BIN_COUNT - 1 - i;
+            if (bins[j].count > 0)
+            {
+                right_bounds = right_sum == 0 ? bins[j].bounds : right_bounds;
+                right_bounds.expand(bins[j].bounds);
+                right_sum += bins[j].count;
+            }
+            right_count[j - 1] = right_sum;
+            right_area[j - 1] = right_bounds.get_half_perimeter();
+        }
+
+        for (int i = 0; i < BIN_COUNT - 1; i++)
+        {
+            if (left_count[i] == 0 || right_count[i] == 0)
+            {
+                continue;
+            }
+
+            const float cost = left_count[i] * left_area[i] + right_count[i] * right_area[i];
+            if (cost < best_cost)
+            {
+                best_cost = cost;
+                best_axis = axis;
+                best_split = bounds_min + (i + 1) / scale;
+            }
+        }
+    }
+
+    // Keep the leaf if no split beats testing every item in it, counting one box test for visiting the children.
+    const float leaf_cost = node.count * node.bounds.get_half_perimeter();
+    const float split_cost = best_cost + node.bounds.get_half_perimeter();
+    if (best_axis < 0 || (split_cost >= leaf_cost && node.count <= MAX_LEAF_SIZE))
+    {
+        return;
+    }
+
+    // Partition the items around the split plane.
+    int* begin = _items.data() + node.first;
+    int* middle = std::partition(begin, begin + node.count, [this, best_axis, best_split](int item)
+    {
+        return _boxes[item].get_center()[best_axis] < best_split;
+    });
+    const int left_count = static_cast<int>(middle - begin);
+    if (left_count == 0 || left_count == node.count)
+    {
+        return;
+    }
+
+    // Children are always allocated as a pair so only the first index has to be stored.
+    const int left_index = static_cast<int>(_nodes.size());
+    _nodes.push_back({ aabb(), node.first, left_count });
+    _nodes.push_back({ aabb(), node.first + left_count, node.count - left_count });
+    update_bounds(_nodes[left_index]);
+    update_bounds(_nodes[left_index + 1]);
+
+    _nodes[node_index].first = left_index;
+    _nodes[node_index].count = 0;
+
+    subdivide(left_index, depth + 1);
+    subdivide(left_index + 1, depth + 1);
+}
+
+// Appends every item overlapping the box to results.
+void engine::physics::bvh::query(const aabb& box, std::vector<int>& results) const
+{
+    if (_nodes.empty())
+    {
+        return;
+    }
+
+    int stack[MAX_DEPTH * 2 + 2];
+    int stack_size = 0;
+    stack[stack_size++] = 0;
+    while (stack_size > 0)
+    {
+        const bvh_node& node = _nodes[stack[--stack_size]];
+        if (!node.bounds.overlaps(box))
+        {
+            continue;
+        }
+
+        if (node.count > 0)
+        {
+            for (int i = node.first; i < node.first + node.count; i++)
+            {
+                if (_boxes[_items[i]].overlaps(box))
+                {
+                    results.push_back(_items[i]);
+                }
+            }
+        }
+        else
+        {
+            stack[stack_size++] = node.first;
+            stack[stack_size++] = node.first + 1;
+        }
+    }
+}
+
+/**
+ * Finds the closest box hit by a ray. The direction doesn't need to be normalized; distances are measured in
+ * multiples of it.
+ */
+bool engine::physics::bvh::raycast(const glm::vec2& origin, const glm::vec2& direction, float max_distance, raycast_hit& hit) const
+{
+    return cast(origin, direction, max_distance, glm::vec2(0.0f, 0.0f), hit);
+}
+
+/**
+ * Finds the first box a moving box touches on its way from its current position to its position plus delta.
+ * The hit distance is the time of impact, from 0 (already touching) to 1 (the end of the move), and the hit point
+ * is where the center of the moving box is at that time.
+ */
+bool engine::physics::bvh::sweep(const aabb& box, const glm::vec2& delta, raycast_hit& hit) const
+{
+    return cast(box.get_center(), delta, 1.0f, box.get_size() * 0.5f, hit);
+}
+
+/**
+ * Casts a ray against every box grown by extents, which is the same as sweeping a box with those half extents.
+ * Children are visited nearest first so farther subtrees can be skipped once something is hit.
+ */
+bool engine::physics::bvh::cast(const glm::vec2& origin, const glm::vec2& direction, float max_distance, const glm::vec2& extents, raycast_hit& hit) const
+{
+    if (_nodes.empty())
+    {
+        return false;
+    }
+
+    const glm::vec2 inverse_direction = get_inverse_direction(direction);
+    float closest = max_distance;
+    int closest_item = -1;
+
+    float distance;
+    if (!_nodes[0].bounds.inflated(extents).intersect_ray(origin, inverse_direction, closest, distance))
+    {
+        return false;
+    }
+
+    int stack[MAX_DEPTH * 2 + 2];
+    int stack_size = 0;
+    stack[stack_size++] = 0;
+    while (stack_size > 0)
+    {
+        const bvh_node& node = _nodes[stack[--stack_size]];
+        if (!node.bounds.inflated(extents).intersect_ray(origin, inverse_direction, closest, distance))
+        {
+            continue;
+        }
+
+        if (node.count > 0)
+        {
+            for (int i = node.first; i < node.first + node.count; i++)
+            {
+                if (_boxes[_items[i]].inflated(extents).intersect_ray(origin, inverse_direction, closest, distance) && (distance < closest || closest_item < 0))
+                {
+                    closest = distance;
+                    closest_item = _items[i];
+                }
+            }
+            continue;
+        }
+
+        float left_distance, right_distance;
+        const bool left_hit = _nodes[node.first].bounds.inflated(extents).intersect_ray(origin, inverse_direction, closest, left_distance);
+        const bool right_hit = _nodes[node.first + 1].bounds.inflated(extents).intersect_ray(origin, inverse_direction, closest, right_distance);
+
+        // Push the farther child first so the nearer one is popped next.
+        if (left_hit && right_hit)
+        {
+            const bool left_first = left_distance <= right_distance;
+            stack[stack_size++] = left_first ? node.first + 1 : node.first;
+            stack[stack_size++] = left_first ? node.first : node.first + 1;
+        }
+        else if (left_hit)
+        {
+            stack[stack_size++] = node.first;
+        }
+        else if (right_hit)
+        {
+            stack[stack_size++] = node.first + 1;
+        }
+    }
+
+    if (closest_item < 0)
+    {
+        return false;
+    }
+
+    // Work out which face was entered for the normal.
+    const aabb box = _boxes[closest_item].inflated(extents);
+    hit.item = closest_item;
+    hit.distance = closest;
+    hit.point = origin + direction * closest;
+    hit.normal = get_ray_entry_normal(box, origin, direction);
+
+    return true;
+}
@@ -0,0 +1,58 @@
+#ifndef ENGINE_BVH_H
+#define ENGINE_BVH_H
+
+#include <vector>
+#include <glm/vec2.hpp>
+#include "aabb.h"
+
+namespace engine::physics
+{
+    /**
+     * Node of a flattened bounding volume hierarchy.
+     * Leaves (count > 0) own items [first, first + count) of the item list. Inner nodes have their two children
+     * next to each other, starting at first.
+     */
+    struct bvh_node
+    {
+        aabb bounds;
+        int first;
+        int count;
+    };
+
+    /**
+     * Bounding volume hierarchy over boxes that never move, built once with binned SAH splits and stored
+     * as one contiguous array of nodes. Items are identified by their index in the vector passed to build().
+     * Queries are read only and safe to run from several threads at once.
+     */
+    class bvh
+    {
+        private:
+            std::vector<aabb> _boxes;
+            std::vector<int> _items;
+            std::vector<bvh_node> _nodes;
+
+            void subdivide(int node_index, int depth);
+            void update_bounds(bvh_node& node) const;
+            bool cast(const glm::vec2& origin, const glm::vec2& direction, float max_distance, const glm::vec2& extents, raycast_hit& hit) const;
+
+        public:
+            static const int BIN_COUNT = 8;
+            static const int MAX_LEAF_SIZE = 4;
+            // Limits the tree depth so traversal can use a fixed size stack.
+            static const int MAX_DEPTH = 32;
+
+            bvh() = default;
+            ~bvh() = default;
+
+            bool is_empty() const;
+            int get_node_count() const;
+            const std::vector<aabb>& get_boxes() const;
+
+            void build(const std::vector<aabb>& boxes);
+            void query(const aabb& box, std::vector<int>& results) const;
+            bool raycast(const glm::vec2& origin, const glm::vec2& direction, float max_distance, raycast_hit& hit) const;
+            bool sweep(const aabb& box, const glm::vec2& delta, raycast_hit& hit) const;
+    };
+}
+
+#endif
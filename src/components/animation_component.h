@@ -0,0 +1,31 @@
+#ifndef ENGINE_ANIMATIONCOMPONENT_H
+#define ENGINE_ANIMATIONCOMPONENT_H
+
+namespace engine::components
+{
+    struct animation_component
+    {
+        // Clip of the animation library to play. -1 stops animating and leaves the sprite as it is.
+        // Switching clips restarts playback from the new clip's first frame.
+        int clip;
+        // Playback rate, where 1 is the clip's own rate.
+        float speed;
+        // Frame shown, updated by the animation system. -1 until the first update.
+        int frame;
+        // Seconds into the clip.
+        float time;
+        // Clip the frame and time belong to, updated by the animation system. -1 until the first update.
+        int playing_clip;
+
+        animation_component(int clip = -1, float speed = 1.0f)
+        {
+            this->clip = clip;
+            this->speed = speed;
+            this->frame = -1;
+            this->time = 0.0f;
+            this->playing_clip = -1;
+        }
+    };
+}
+
+#endif
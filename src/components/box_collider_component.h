@@ -0,0 +1,29 @@
+#ifndef ENGINE_BOXCOLLIDERCOMPONENT_H
+#define ENGINE_BOXCOLLIDERCOMPONENT_H
+
+#include <glm/vec2.hpp>
+
+namespace engine::components
+{
+    struct box_collider_component
+    {
+        int width;
+        int height;
+        glm::vec2 offset;
+        // Static colliders never move. They are built into a hierarchy once per level instead of every tick.
+        bool is_static;
+        // Continuous colliders are swept along their motion each tick so fast movers can't tunnel through thin obstacles.
+        bool is_continuous;
+
+        box_collider_component(int width = 0, int height = 0, glm::vec2 offset = glm::vec2(0.0, 0.0), bool is_static = false, bool is_continuous = false)
+        {
+            this->width = width;
+            this->height = height;
+            this->offset = offset;
+            this->is_static = is_static;
+            this->is_continuous = is_continuous;
+        }
+    };
+}
+
+#endif
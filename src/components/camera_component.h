@@ -0,0 +1,37 @@
+#ifndef ENGINE_CAMERACOMPONENT_H
+#define ENGINE_CAMERACOMPONENT_H
+
+#include <glm/vec2.hpp>
+#include "../aabb.h"
+
+namespace engine::components
+{
+    struct camera_component
+    {
+        // Size of the screen area the camera draws to, in pixels.
+        glm::vec2 viewport;
+        // Screen pixels per world unit.
+        float zoom;
+        // The view is kept inside these world bounds. Unbounded if max isn't greater than min.
+        glm::vec2 bounds_min;
+        glm::vec2 bounds_max;
+        // Entity whose position the camera centers on, offset by target_offset. -1 to stay put.
+        int target_id;
+        glm::vec2 target_offset;
+        // World area seen by the camera, updated by the camera system.
+        physics::aabb view;
+
+        camera_component(glm::vec2 viewport = glm::vec2(0.0, 0.0), float zoom = 1.0f, glm::vec2 bounds_min = glm::vec2(0.0, 0.0), glm::vec2 bounds_max = glm::vec2(0.0, 0.0), int target_id = -1, glm::vec2 target_offset = glm::vec2(0.0, 0.0))
+        {
+            this->viewport = viewport;
+            this->zoom = zoom;
+            this->bounds_min = bounds_min;
+            this->bounds_max = bounds_max;
+            this->target_id = target_id;
+            this->target_offset = target_offset;
+            this->view = physics::aabb(glm::vec2(0.0f, 0.0f), viewport);
+        }
+    };
+}
+
+#endif
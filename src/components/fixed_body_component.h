@@ -0,0 +1,26 @@
+#ifndef ENGINE_FIXEDBODYCOMPONENT_H
+#define ENGINE_FIXEDBODYCOMPONENT_H
+
+#include <glm/vec2.hpp>
+#include "../fixed_point.h"
+
+namespace engine::components
+{
+    /**
+     * Fixed point position and velocity, simulated by the deterministic movement system.
+     * The transform position is derived from this every tick and only used for rendering.
+     */
+    struct fixed_body_component
+    {
+        fixed_vec2 position;
+        fixed_vec2 velocity;
+
+        fixed_body_component(glm::vec2 position = glm::vec2(0.0, 0.0), glm::vec2 velocity = glm::vec2(0.0, 0.0))
+        {
+            this->position = fixed_vec2::from_vec2(position);
+            this->velocity = fixed_vec2::from_vec2(velocity);
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef ENGINE_FLOWFIELDCOMPONENT_H
+#define ENGINE_FLOWFIELDCOMPONENT_H
+
+#include <glm/vec2.hpp>
+
+namespace engine::components
+{
+    struct flow_field_component
+    {
+        // Tile to head towards. Every entity with the same goal shares one flow field.
+        glm::ivec2 goal;
+        float speed;
+        // Point sampled from the field, relative to the entity's position. Usually the center of the entity.
+        glm::vec2 anchor;
+
+        flow_field_component(glm::ivec2 goal = glm::ivec2(0, 0), float speed = 0.0f, glm::vec2 anchor = glm::vec2(0.0, 0.0))
+        {
+            this->goal = goal;
+            this->speed = speed;
+            this->anchor = anchor;
+        }
+    };
+}
+
+#endif
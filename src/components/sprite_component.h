@@ -3,21 +3,29 @@
 
 #include <string>
 #include <SDL2/SDL.h>
+#include "../resources.h"
 
 namespace engine::components
 {
     struct sprite_component
     {
-        std::string asset_id;
+        // Resolved from the asset ID once, when the component is created.
+        resources::texture_handle texture;
         int width;
         int height;
         SDL_Rect src_rect;
+        // Sprites on higher layers are drawn on top of lower ones.
+        int layer;
+        // Static sprites never move, so they're only indexed for culling once.
+        bool is_static;
 
-        sprite_component(std::string asset_id = "", int width = 0, int height = 0, int src_rect_x = 0, int src_rect_y = 0)
+        sprite_component(std::string asset_id = "", int width = 0, int height = 0, int src_rect_x = 0, int src_rect_y = 0, int layer = 0, bool is_static = false)
         {
-            this->asset_id = asset_id;
+            this->texture = resources::get_texture_handle(asset_id);
             this->width = width;
             this->height = height;
+            this->layer = layer;
+            this->is_static = is_static;
             this->src_rect =
             {
                 src_rect_x,
@@ -0,0 +1,37 @@
+#ifndef ENGINE_STEERINGCOMPONENT_H
+#define ENGINE_STEERINGCOMPONENT_H
+
+#include <glm/vec2.hpp>
+
+namespace engine::components
+{
+    struct steering_component
+    {
+        // Other steering entities closer than this are neighbours.
+        float neighbor_radius;
+        float max_speed;
+        // Point steered, relative to the entity's position. Usually the center of the entity.
+        glm::vec2 anchor;
+        // Steering accelerations, in pixels per second squared at full strength.
+        float separation_weight;
+        float alignment_weight;
+        float cohesion_weight;
+        float avoidance_weight;
+        // How far ahead, in seconds of travel, solid tiles are avoided.
+        float look_ahead;
+
+        steering_component(float neighbor_radius = 48.0f, float max_speed = 100.0f, glm::vec2 anchor = glm::vec2(0.0, 0.0), float separation_weight = 600.0f, float alignment_weight = 60.0f, float cohesion_weight = 30.0f, float avoidance_weight = 400.0f, float look_ahead = 0.5f)
+        {
+            this->neighbor_radius = neighbor_radius;
+            this->max_speed = max_speed;
+            this->anchor = anchor;
+            this->separation_weight = separation_weight;
+            this->alignment_weight = alignment_weight;
+            this->cohesion_weight = cohesion_weight;
+            this->avoidance_weight = avoidance_weight;
+            this->look_ahead = look_ahead;
+        }
+    };
+}
+
+#endif
@@ -11,11 +11,17 @@ namespace engine::components
         glm::vec2 scale;
         double rotation;
 
+        // State at the start of the most recent simulation tick, used to interpolate between ticks when rendering.
+        glm::vec2 previous_position;
+        double previous_rotation;
+
         transform_component(glm::vec2 position = glm::vec2(0, 0), glm::vec2 scale = glm::vec2(1, 1), double rotation = 0.0)
         {
             this->position = position;
             this->scale = scale;
             this->rotation = rotation;
+            this->previous_position = position;
+            this->previous_rotation = rotation;
         }
     };
 }
@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <vector>
+#include <SDL2/SDL.h>
+#include "dirty_rects.h"
+#include "render_frame.h"
+
+namespace
+{
+    bool overlaps(const SDL_Rect& a, const SDL_Rect& b)
+    {
+        return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+    }
+
+    SDL_Rect get_union(const SDL_Rect& a, const SDL_Rect& b)
+    {
+        const int min_x = std::min(a.x, b.x);
+        const int min_y = std::min(a.y, b.y);
+        const int max_x = std::max(a.x + a.w, b.x + b.w);
+        const int max_y = std::max(a.y + a.h, b.y + b.h);
+        return { min_x, min_y, max_x - min_x, max_y - min_y };
+    }
+
+    long long get_area(const SDL_Rect& rect)
+    {
+        return static_cast<long long>(rect.w) * rect.h;
+    }
+}
+
+bool engine::dirty_rect_tracker::is_before(const quad_signature& a, const quad_signature& b)
+{
+    return std::tie(a.bounds.x, a.bounds.y, a.bounds.w, a.bounds.h, a.texture, a.corner.x, a.corner.y, a.first_uv.x, a.first_uv.y, a.last_uv.x, a.last_uv.y)
+        < std::tie(b.bounds.x, b.bounds.y, b.bounds.w, b.bounds.h, b.texture, b.corner.x, b.corner.y, b.first_uv.x, b.first_uv.y, b.last_uv.x, b.last_uv.y);
+}
+
+// Reduces every quad of a frame to its signature, sorted so two frames can be compared in one pass.
+void engine::dirty_rect_tracker::collect(const render_frame& frame)
+{
+    _current.clear();
+    for (const sprite_batch& batch: frame.batches)
+    {
+        const SDL_Vertex* vertices = frame.vertices.data() + batch.first_vertex;
+        for (int i = 0; i + 3 < batch.vertex_count; i += 4)
+        {
+            float min_x = vertices[i].position.x;
+            float min_y = vertices[i].position.y;
+            float max_x = min_x;
+            float max_y = min_y;
+            for (int corner = 1; corner < 4; corner++)
+            {
+                min_x = std::min(min_x, vertices[i + corner].position.x);
+                min_y = std::min(min_y, vertices[i + corner].position.y);
+                max_x = std::max(max_x, vertices[i + corner].position.x);
+                max_y = std::max(max_y, vertices[i + corner].position.y);
+            }
+
+            // Pad by a pixel so edge pixels touched by rounding are covered too.
+            const int x = static_cast<int>(std::floor(min_x)) - 1;
+            const int y = static_cast<int>(std::floor(min_y)) - 1;
+            const SDL_Rect bounds = {
+                x,
+                y,
+                static_cast<int>(std::ceil(max_x)) + 1 - x,
+                static_cast<int>(std::ceil(max_y)) + 1 - y
+            };
+            _current.push_back({ bounds, batch.texture, vertices[i].position, vertices[i].tex_coord, vertices[i + 2].tex_coord });
+        }
+    }
+
+    std::sort(_current.begin(), _current.end(), is_before);
+}
+
+/**
+ * Clips a rectangle to the screen and adds it, merging it with every rectangle it overlaps. Once the list is
+ * full, the rectangle is merged into whichever one grows the least instead.
+ */
+void engine::dirty_rect_tracker::add_rect(SDL_Rect rect, int screen_width, int screen_height)
+{
+    const int min_x = std::max(rect.x, 0);
+    const int min_y = std::max(rect.y, 0);
+    const int max_x = std::min(rect.x + rect.w, screen_width);
+    const int max_y = std::min(rect.y + rect.h, screen_height);
+    if (max_x <= min_x || max_y <= min_y)
+    {
+        return;
+    }
+
+    rect = { min_x, min_y, max_x - min_x, max_y - min_y };
+    while (true)
+    {
+        bool merged = false;
+        for (size_t i = 0; i < _rects.size(); i++)
+        {
+            if (overlaps(_rects[i], rect))
+            {
+                rect = get_union(_rects[i], rect);
+                _rects.erase(_rects.begin() + i);
+                merged = true;
+                break;
+            }
+        }
+
+        if (merged)
+        {
+            continue;
+        }
+
+        if (static_cast<int>(_rects.size()) < MAX_RECTS)
+        {
+            _rects.push_back(rect);
+            return;
+        }
+
+        size_t best = 0;
+        long long best_growth = -1;
+        for (size_t i = 0; i < _rects.size(); i++)
+        {
+            const long long growth = get_area(get_union(_rects[i], rect)) - get_area(_rects[i]);
+            if (best_growth < 0 || growth < best_growth)
+            {
+                best = i;
+                best_growth = growth;
+            }
+        }
+
+        // The grown rectangle may now overlap others, so go around again.
+        rect = get_union(_rects[best], rect);
+        _rects.erase(_rects.begin() + best);
+    }
+}
+
+// Forces the next frame to be redrawn in full, such as after the view moved or the ground changed.
+void engine::dirty_rect_tracker::invalidate()
+{
+    _is_invalidated = true;
+}
+
+/**
+ * Compares a frame against the one before it. Returns true if redrawing get_rects() is enough, or false if the
+ * whole screen has to be redrawn. Either way the frame becomes the one the next is compared against.
+ */
+bool engine::dirty_rect_tracker::update(const render_frame& frame, int screen_width, int screen_height)
+{
+    collect(frame);
+    _rects.clear();
+
+    size_t previous = 0;
+    size_t current = 0;
+    while (previous < _previous.size() || current < _current.size())
+    {
+        if (current == _current.size() || (previous < _previous.size() && is_before(_previous[previous], _current[current])))
+        {
+            add_rect(_previous[previous++].bounds, screen_width, screen_height);
+        }
+        else if (previous == _previous.size() || is_before(_current[current], _previous[previous]))
+        {
+            add_rect(_current[current++].bounds, screen_width, screen_height);
+        }
+        else
+        {
+            previous++;
+            current++;
+        }
+    }
+
+    _previous.swap(_current);
+
+    long long dirty_pixels = 0;
+    for (const SDL_Rect& rect: _rects)
+    {
+        dirty_pixels += get_area(rect);
+    }
+
+    const bool is_partial = !_is_invalidated && dirty_pixels <= full_redraw_threshold * get_area({ 0, 0, screen_width, screen_height });
+    _is_invalidated = false;
+
+    _stats.frames++;
+    if (is_partial)
+    {
+        _stats.dirty_pixels += dirty_pixels;
+    }
+    else
+    {
+        _stats.full_frames++;
+        _rects.clear();
+    }
+
+    return is_partial;
+}
+
+const std::vector<SDL_Rect>& engine::dirty_rect_tracker::get_rects() const
+{
+    return _rects;
+}
+
+engine::dirty_rect_stats engine::dirty_rect_tracker::get_stats() const
+{
+    return _stats;
+}
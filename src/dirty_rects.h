@@ -0,0 +1,67 @@
+#ifndef ENGINE_DIRTYRECTS_H
+#define ENGINE_DIRTYRECTS_H
+
+#include <vector>
+#include <SDL2/SDL.h>
+#include "render_frame.h"
+
+namespace engine
+{
+    // Running totals of how frames were redrawn.
+    struct dirty_rect_stats
+    {
+        unsigned long long frames;
+        unsigned long long full_frames;
+        unsigned long long dirty_pixels;
+    };
+
+    /**
+     * Finds the parts of the screen that changed between two frames, so a renderer that keeps its back buffer
+     * (the software renderer) only has to redraw those.
+     *
+     * Every quad of a frame is reduced to a signature: its screen bounds, texture, first corner and texture
+     * coordinates. Quads whose signature is in only one of the two frames appeared, disappeared, moved or changed
+     * image, and their bounds, old and new, are dirty. Dirty rectangles are merged until none overlap, so each
+     * pixel is redrawn once, and at most MAX_RECTS are kept. When they cover more than full_redraw_threshold of
+     * the screen, redrawing everything is cheaper and update() asks for that instead.
+     */
+    class dirty_rect_tracker
+    {
+        private:
+            struct quad_signature
+            {
+                SDL_Rect bounds;
+                SDL_Texture* texture;
+                SDL_FPoint corner;
+                SDL_FPoint first_uv;
+                SDL_FPoint last_uv;
+            };
+
+            std::vector<quad_signature> _previous;
+            std::vector<quad_signature> _current;
+            std::vector<SDL_Rect> _rects;
+            bool _is_invalidated = true;
+            dirty_rect_stats _stats = { 0, 0, 0 };
+
+            static bool is_before(const quad_signature& a, const quad_signature& b);
+            void collect(const render_frame& frame);
+            void add_rect(SDL_Rect rect, int screen_width, int screen_height);
+
+        public:
+            static const int MAX_RECTS = 16;
+
+            dirty_rect_tracker() = default;
+            ~dirty_rect_tracker() = default;
+
+            // Fraction of the screen above which the whole frame is redrawn instead.
+            float full_redraw_threshold = 0.5f;
+
+            void invalidate();
+            bool update(const render_frame& frame, int screen_width, int screen_height);
+
+            const std::vector<SDL_Rect>& get_rects() const;
+            dirty_rect_stats get_stats() const;
+    };
+}
+
+#endif
@@ -12,6 +12,7 @@ int engine::ecs::entity::get_id() const {
 void engine::ecs::system::add_entity_to_system(ecs::entity entity)
 {
     _entities.push_back(entity);
+    _entities_version++;
 }
 
 void engine::ecs::system::remove_entity_from_system(ecs::entity entity)
@@ -48,6 +49,7 @@ void engine::ecs::system::remove_entity_from_system(ecs::entity entity)
         ),
         _entities.end()
     );
+    _entities_version++;
 }
 
 std::vector<engine::ecs::entity> engine::ecs::system::get_system_entities() const
@@ -55,11 +57,64 @@ std::vector<engine::ecs::entity> engine::ecs::system::get_system_entities() cons
     return _entities;
 }
 
+/**
+ * Returns the slice of entities to process this tick when a system spreads its entities across its update interval.
+ * Every entity lands in exactly one slice, so each entity is processed once per interval.
+ */
+std::vector<engine::ecs::entity> engine::ecs::system::get_staggered_entities(unsigned long long tick) const
+{
+    if (_update_interval <= 1)
+    {
+        return _entities;
+    }
+
+    const int slice = static_cast<int>((tick + _update_phase) % _update_interval);
+    std::vector<ecs::entity> entities;
+    entities.reserve(_entities.size() / _update_interval + 1);
+    for (const ecs::entity entity: _entities)
+    {
+        if (entity.get_id() % _update_interval == slice)
+        {
+            entities.push_back(entity);
+        }
+    }
+    return entities;
+}
+
 const engine::ecs::signature& engine::ecs::system::get_component_signature() const
 {
     return _component_signature;
 }
 
+// Changes whenever the system's entities do, so anything derived from them can tell when it's out of date.
+unsigned int engine::ecs::system::get_entities_version() const
+{
+    return _entities_version;
+}
+
+void engine::ecs::system::set_update_interval(int interval, int phase_offset)
+{
+    _update_interval = interval < 1 ? 1 : interval;
+    _update_phase = phase_offset % _update_interval;
+}
+
+int engine::ecs::system::get_update_interval() const
+{
+    return _update_interval;
+}
+
+// Whether a system with an update interval should run on this tick.
+bool engine::ecs::system::is_update_due(unsigned long long tick) const
+{
+    return (tick + _update_phase) % _update_interval == 0;
+}
+
+// Time that passes between two updates of this system.
+double engine::ecs::system::get_update_delta_time(double tick_delta_time) const
+{
+    return tick_delta_time * _update_interval;
+}
+
 void engine::ecs::registry::update()
 {
     // Create all entities that are pending creation.
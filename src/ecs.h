@@ -75,19 +75,34 @@ namespace engine::ecs
     /**
      * A system handles processing all entities that contain specific components.
      * A component signature or, bitset, is used to determine which components the system requires each entity to have.
+     *
+     * By default a system is updated every simulation tick. Systems that don't need that can be given an update
+     * interval (in ticks) and a phase offset, so low frequency systems run on different ticks instead of all at once.
      */
     class system
     {
         private:
             ecs::signature _component_signature;
             std::vector<ecs::entity> _entities;
+            // Incremented whenever an entity is added or removed.
+            unsigned int _entities_version = 0;
+
+            int _update_interval = 1;
+            int _update_phase = 0;
 
         public:
             system() = default;
             ~system() = default;
 
             std::vector<ecs::entity> get_system_entities() const;
+            std::vector<ecs::entity> get_staggered_entities(unsigned long long tick) const;
             const ecs::signature& get_component_signature() const;
+            unsigned int get_entities_version() const;
+
+            void set_update_interval(int interval, int phase_offset = 0);
+            int get_update_interval() const;
+            bool is_update_due(unsigned long long tick) const;
+            double get_update_delta_time(double tick_delta_time) const;
 
             void add_entity_to_system(ecs::entity entity);
             void remove_entity_from_system(ecs::entity entity);
@@ -190,6 +205,7 @@ namespace engine::ecs
             template <typename TSystem> void remove_system();
             template <typename TSystem> bool has_system() const;
             template <typename TSystem> TSystem& get_system() const;
+            template <typename TSystem> void set_system_update_rate(double frequency, int tick_rate, int phase_offset = -1);
     };
 
     // Registry template function implementations.
@@ -296,6 +312,35 @@ namespace engine::ecs
         return *(std::static_pointer_cast<TSystem>(system->second));
     }
 
+    /**
+     * Runs a system at roughly the given frequency (in Hz) instead of every tick.
+     * If no phase offset is given, one is picked so systems sharing the same interval are spread across different ticks.
+     */
+    template <typename TSystem>
+    void ecs::registry::set_system_update_rate(double frequency, int tick_rate, int phase_offset)
+    {
+        int interval = 1;
+        if (frequency > 0.0 && frequency < tick_rate)
+        {
+            interval = static_cast<int>(tick_rate / frequency + 0.5);
+        }
+
+        if (phase_offset < 0)
+        {
+            int systems_with_interval = 0;
+            for (auto& system: systems)
+            {
+                if (system.first != std::type_index(typeid(TSystem)) && system.second->get_update_interval() == interval)
+                {
+                    systems_with_interval++;
+                }
+            }
+            phase_offset = systems_with_interval % interval;
+        }
+
+        get_system<TSystem>().set_update_interval(interval, phase_offset);
+    }
+
     // System template function implementations.
 
     template <typename TComponent>
@@ -0,0 +1,80 @@
+#ifndef ENGINE_FIXEDPOINT_H
+#define ENGINE_FIXEDPOINT_H
+
+#include <cstdint>
+#include <glm/vec2.hpp>
+
+namespace engine
+{
+    /**
+     * Signed 48.16 fixed point number, used by the deterministic simulation mode.
+     *
+     * All arithmetic is done on integers so results are bit-exact across machines and compilers.
+     * Conversions to and from floating point are only meant for loading data and for rendering.
+     * Multiplication and division truncate towards zero, which is well defined in C++. Sums stay in range for any
+     * world coordinate; a product (or quotient times the divisor) must stay below 2^31 in magnitude, which the
+     * deterministic movement system guarantees by keeping bodies inside the world.
+     */
+    struct fixed
+    {
+        static constexpr int FRACTION_BITS = 16;
+        static constexpr int64_t ONE = int64_t(1) << FRACTION_BITS;
+
+        int64_t raw;
+
+        constexpr fixed(): raw(0) {}
+
+        static constexpr fixed from_raw(int64_t raw) { fixed f; f.raw = raw; return f; }
+        static constexpr fixed from_int(int value) { return from_raw(value * ONE); }
+        static fixed from_float(double value) { return from_raw(static_cast<int64_t>(value * ONE + (value < 0.0 ? -0.5 : 0.5))); }
+
+        // Fraction numerator / denominator, computed with integer math only.
+        static constexpr fixed from_ratio(int numerator, int denominator)
+        {
+            return from_raw((numerator * ONE) / denominator);
+        }
+
+        float to_float() const { return static_cast<float>(raw) / ONE; }
+
+        constexpr fixed operator +(fixed other) const { return from_raw(raw + other.raw); }
+        constexpr fixed operator -(fixed other) const { return from_raw(raw - other.raw); }
+        constexpr fixed operator -() const { return from_raw(-raw); }
+        constexpr fixed operator *(fixed other) const { return from_raw((raw * other.raw) / ONE); }
+        constexpr fixed operator /(fixed other) const { return from_raw((raw * ONE) / other.raw); }
+
+        fixed& operator +=(fixed other) { raw += other.raw; return *this; }
+        fixed& operator -=(fixed other) { raw -= other.raw; return *this; }
+        fixed& operator *=(fixed other) { return *this = *this * other; }
+        fixed& operator /=(fixed other) { return *this = *this / other; }
+
+        constexpr bool operator ==(fixed other) const { return raw == other.raw; }
+        constexpr bool operator !=(fixed other) const { return raw != other.raw; }
+        constexpr bool operator <(fixed other) const { return raw < other.raw; }
+        constexpr bool operator >(fixed other) const { return raw > other.raw; }
+        constexpr bool operator <=(fixed other) const { return raw <= other.raw; }
+        constexpr bool operator >=(fixed other) const { return raw >= other.raw; }
+    };
+
+    /**
+     * Two dimensional vector of fixed point numbers.
+     */
+    struct fixed_vec2
+    {
+        fixed x;
+        fixed y;
+
+        constexpr fixed_vec2() = default;
+        constexpr fixed_vec2(fixed x, fixed y): x(x), y(y) {}
+
+        static fixed_vec2 from_vec2(const glm::vec2& v) { return fixed_vec2(fixed::from_float(v.x), fixed::from_float(v.y)); }
+        glm::vec2 to_vec2() const { return glm::vec2(x.to_float(), y.to_float()); }
+
+        constexpr fixed_vec2 operator +(const fixed_vec2& other) const { return fixed_vec2(x + other.x, y + other.y); }
+        constexpr fixed_vec2 operator -(const fixed_vec2& other) const { return fixed_vec2(x - other.x, y - other.y); }
+        constexpr fixed_vec2 operator *(fixed scalar) const { return fixed_vec2(x * scalar, y * scalar); }
+
+        fixed_vec2& operator +=(const fixed_vec2& other) { x += other.x; y += other.y; return *this; }
+    };
+}
+
+#endif
@@ -0,0 +1,201 @@
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <utility>
+#include <vector>
+#include "flow_field.h"
+
+engine::navigation::flow_field::flow_field()
+{
+    _width = 0;
+    _height = 0;
+    _tile_size = 1;
+    _goal = glm::ivec2(0, 0);
+}
+
+/**
+ * Builds the field for a goal tile with the same moves as search_context::find_path: 8 way, without cutting
+ * the corners of solid tiles. Solid and unreachable tiles get a negative cost and no direction.
+ */
+void engine::navigation::flow_field::build(const physics::solidity_grid& grid, glm::ivec2 goal)
+{
+    _width = grid.get_width();
+    _height = grid.get_height();
+    _tile_size = grid.get_tile_size();
+    _goal = goal;
+    _costs.assign(_width * _height, -1.0f);
+    _directions.assign(_width * _height, glm::vec2(0.0f, 0.0f));
+
+    if (grid.is_solid(goal.x, goal.y))
+    {
+        return;
+    }
+
+    const float diagonal_cost = 1.41421356f;
+    const int offsets_x[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+    const int offsets_y[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+
+    // Integration field.
+    typedef std::pair<float, int> entry;
+    std::priority_queue<entry, std::vector<entry>, std::greater<entry>> open;
+    _costs[goal.y * _width + goal.x] = 0.0f;
+    open.push(entry(0.0f, goal.y * _width + goal.x));
+    while (!open.empty())
+    {
+        const entry top = open.top();
+        open.pop();
+        if (top.first > _costs[top.second])
+        {
+            continue;
+        }
+
+        const int x = top.second % _width;
+        const int y = top.second / _width;
+        for (int i = 0; i < 8; i++)
+        {
+            const int next_x = x + offsets_x[i];
+            const int next_y = y + offsets_y[i];
+            if (grid.is_solid(next_x, next_y))
+            {
+                continue;
+            }
+
+            const bool is_diagonal = i >= 4;
+            if (is_diagonal && (grid.is_solid(next_x, y) || grid.is_solid(x, next_y)))
+            {
+                continue;
+            }
+
+            const int next = next_y * _width + next_x;
+            const float cost = top.first + (is_diagonal ? diagonal_cost : 1.0f);
+            if (_costs[next] < 0.0f || cost < _costs[next])
+            {
+                _costs[next] = cost;
+                open.push(entry(cost, next));
+            }
+        }
+    }
+
+    // Direction field. Moves are symmetric, so every move the integration pass made can be walked back.
+    for (int y = 0; y < _height; y++)
+    {
+        for (int x = 0; x < _width; x++)
+        {
+            const float cost = _costs[y * _width + x];
+            if (cost <= 0.0f)
+            {
+                continue;
+            }
+
+            float best_cost = cost;
+            int best = -1;
+            for (int i = 0; i < 8; i++)
+            {
+                const int next_x = x + offsets_x[i];
+                const int next_y = y + offsets_y[i];
+                if (!grid.is_inside(next_x, next_y))
+                {
+                    continue;
+                }
+
+                const bool is_diagonal = i >= 4;
+                if (is_diagonal && (grid.is_solid(next_x, y) || grid.is_solid(x, next_y)))
+                {
+                    continue;
+                }
+
+                const float next_cost = _costs[next_y * _width + next_x];
+                if (next_cost >= 0.0f && next_cost < best_cost)
+                {
+                    best_cost = next_cost;
+                    best = i;
+                }
+            }
+
+            if (best >= 0)
+            {
+                const glm::vec2 offset(offsets_x[best], offsets_y[best]);
+                _directions[y * _width + x] = offset / std::sqrt(offset.x * offset.x + offset.y * offset.y);
+            }
+        }
+    }
+}
+
+glm::ivec2 engine::navigation::flow_field::get_goal() const
+{
+    return _goal;
+}
+
+bool engine::navigation::flow_field::is_reachable(int x, int y) const
+{
+    return get_cost(x, y) >= 0.0f;
+}
+
+// Path distance from a tile to the goal, in tiles. Negative if the goal can't be reached from it.
+float engine::navigation::flow_field::get_cost(int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= _width || y >= _height)
+    {
+        return -1.0f;
+    }
+
+    return _costs[y * _width + x];
+}
+
+// Unit direction to move in from a tile. Zero on the goal and on tiles that can't reach it.
+glm::vec2 engine::navigation::flow_field::get_direction(int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= _width || y >= _height)
+    {
+        return glm::vec2(0.0f, 0.0f);
+    }
+
+    return _directions[y * _width + x];
+}
+
+// Direction to move in from a world position.
+glm::vec2 engine::navigation::flow_field::sample(const glm::vec2& position) const
+{
+    const int x = static_cast<int>(std::floor(position.x / _tile_size));
+    const int y = static_cast<int>(std::floor(position.y / _tile_size));
+    return get_direction(x, y);
+}
+
+engine::navigation::flow_field_cache::flow_field_cache(const physics::solidity_grid* grid)
+{
+    _grid = grid;
+    _grid_version = grid->get_version();
+}
+
+// Returns the field for a goal tile, building it if it isn't cached.
+std::shared_ptr<const engine::navigation::flow_field> engine::navigation::flow_field_cache::get(glm::ivec2 goal)
+{
+    if (_grid_version != _grid->get_version())
+    {
+        _fields.clear();
+        _grid_version = _grid->get_version();
+    }
+
+    const int key = goal.y * _grid->get_width() + goal.x;
+    auto cached = _fields.find(key);
+    if (cached != _fields.end())
+    {
+        return cached->second;
+    }
+
+    if (static_cast<int>(_fields.size()) >= MAX_CACHED_FIELDS)
+    {
+        _fields.clear();
+    }
+
+    std::shared_ptr<flow_field> field = std::make_shared<flow_field>();
+    field->build(*_grid, goal);
+    _fields[key] = field;
+    return field;
+}
+
+void engine::navigation::flow_field_cache::clear()
+{
+    _fields.clear();
+}
@@ -0,0 +1,65 @@
+#ifndef ENGINE_FLOWFIELD_H
+#define ENGINE_FLOWFIELD_H
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <glm/vec2.hpp>
+#include "solidity_grid.h"
+
+namespace engine::navigation
+{
+    /**
+     * Directions towards one goal tile from every tile of a grid.
+     *
+     * Built in two passes: Dijkstra from the goal fills an integration field with every tile's distance to it,
+     * then each tile points at its cheapest neighbour. Any number of units can then steer towards the goal by
+     * sampling the tile they stand on, instead of each running its own search.
+     */
+    class flow_field
+    {
+        private:
+            int _width;
+            int _height;
+            int _tile_size;
+            glm::ivec2 _goal;
+            std::vector<float> _costs;
+            std::vector<glm::vec2> _directions;
+
+        public:
+            flow_field();
+            ~flow_field() = default;
+
+            void build(const physics::solidity_grid& grid, glm::ivec2 goal);
+
+            glm::ivec2 get_goal() const;
+            bool is_reachable(int x, int y) const;
+            float get_cost(int x, int y) const;
+            glm::vec2 get_direction(int x, int y) const;
+            glm::vec2 sample(const glm::vec2& position) const;
+    };
+
+    /**
+     * Flow fields built on demand and shared by every unit heading to the same goal.
+     * The whole cache is dropped when the grid changes.
+     */
+    class flow_field_cache
+    {
+        private:
+            const physics::solidity_grid* _grid;
+            unsigned int _grid_version;
+            std::unordered_map<int, std::shared_ptr<const flow_field>> _fields;
+
+        public:
+            // Cached fields beyond this count flush the cache.
+            static const int MAX_CACHED_FIELDS = 32;
+
+            flow_field_cache(const physics::solidity_grid* grid);
+            ~flow_field_cache() = default;
+
+            std::shared_ptr<const flow_field> get(glm::ivec2 goal);
+            void clear();
+    };
+}
+
+#endif
@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <cmath>
+#include <SDL2/SDL.h>
+#include "frame_pacer.h"
+
+engine::frame_pacer::frame_pacer()
+{
+    _frequency = 0;
+    _prev_frame = 0;
+    _deadline = 0;
+
+    reset_stats();
+}
+
+// Number of performance counter ticks per frame, or zero when uncapped.
+Uint64 engine::frame_pacer::get_period() const
+{
+    if (target_fps <= 0)
+    {
+        return 0;
+    }
+
+    return _frequency / static_cast<Uint64>(target_fps);
+}
+
+// Restarts pacing from the current time. Call this after long pauses such as level loading.
+void engine::frame_pacer::reset()
+{
+    _frequency = SDL_GetPerformanceFrequency();
+    _prev_frame = SDL_GetPerformanceCounter();
+    _deadline = _prev_frame + get_period();
+}
+
+// Waits until the next frame is due and returns the number of seconds since the previous frame.
+double engine::frame_pacer::wait()
+{
+    if (_frequency == 0)
+    {
+        reset();
+    }
+
+    const Uint64 period = get_period();
+    Uint64 now = SDL_GetPerformanceCounter();
+
+    if (period > 0)
+    {
+        // Sleep while there is comfortably more time left than the spin threshold.
+        const Uint64 spin_ticks = static_cast<Uint64>(spin_threshold * _frequency);
+        if (now < _deadline && _deadline - now > spin_ticks)
+        {
+            const Uint64 sleep_ticks = _deadline - now - spin_ticks;
+            const Uint32 sleep_ms = static_cast<Uint32>((sleep_ticks * 1000) / _frequency);
+            if (sleep_ms > 0)
+            {
+                SDL_Delay(sleep_ms);
+            }
+        }
+
+        // Spin for the rest.
+        now = SDL_GetPerformanceCounter();
+        while (now < _deadline)
+        {
+            now = SDL_GetPerformanceCounter();
+        }
+
+        // The spin above never lets us wake up before the deadline, so the error is how late we are.
+        record_error(static_cast<double>(now - _deadline) / _frequency);
+
+        // Schedule the next frame. If we're more than a whole frame late, don't try to make up the lost frames.
+        _deadline += period;
+        if (_deadline <= now)
+        {
+            _deadline = now + period;
+            _stats_missed_frames++;
+        }
+    }
+
+    const double delta_time = static_cast<double>(now - _prev_frame) / _frequency;
+    _prev_frame = now;
+
+    return delta_time;
+}
+
+void engine::frame_pacer::record_error(double error)
+{
+    _stats_frames++;
+    _stats_error_sum += error;
+    _stats_squared_error_sum += error * error;
+    if (error > _stats_max_error)
+    {
+        _stats_max_error = error;
+    }
+}
+
+// Returns pacing error statistics gathered since the last reset_stats().
+engine::frame_pacing_stats engine::frame_pacer::get_stats() const
+{
+    frame_pacing_stats stats;
+    stats.frames = _stats_frames;
+    stats.missed_frames = _stats_missed_frames;
+    stats.max_error = _stats_max_error;
+    if (_stats_frames > 0)
+    {
+        stats.mean_error = _stats_error_sum / _stats_frames;
+        const double variance = _stats_squared_error_sum / _stats_frames - stats.mean_error * stats.mean_error;
+        stats.error_std_dev = std::sqrt(std::max(variance, 0.0));
+    }
+    return stats;
+}
+
+void engine::frame_pacer::reset_stats()
+{
+    _stats_frames = 0;
+    _stats_missed_frames = 0;
+    _stats_error_sum = 0.0;
+    _stats_squared_error_sum = 0.0;
+    _stats_max_error = 0.0;
+}
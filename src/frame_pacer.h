@@ -0,0 +1,61 @@
+#ifndef ENGINE_FRAMEPACER_H
+#define ENGINE_FRAMEPACER_H
+
+#include <SDL2/SDL.h>
+
+namespace engine
+{
+    /**
+     * Pacing error statistics, in seconds. The error is how late a frame started; the pacer spins up to each
+     * deadline, so frames never start early. The standard deviation shows how much that lateness jitters.
+     */
+    struct frame_pacing_stats
+    {
+        int frames = 0;
+        int missed_frames = 0;
+        double mean_error = 0.0;
+        double error_std_dev = 0.0;
+        double max_error = 0.0;
+    };
+
+    /**
+     * Paces frames to a target rate using the high resolution performance counter.
+     *
+     * SDL_Delay only has millisecond granularity and usually oversleeps, so the pacer sleeps for most of the
+     * remaining frame time and then spins for the last stretch (spin_threshold) to hit the deadline precisely.
+     * Deadlines are scheduled from the previous deadline rather than the previous wake up, so small errors don't drift.
+     */
+    class frame_pacer
+    {
+        private:
+            Uint64 _frequency;
+            Uint64 _prev_frame;
+            Uint64 _deadline;
+
+            int _stats_frames;
+            int _stats_missed_frames;
+            double _stats_error_sum;
+            double _stats_squared_error_sum;
+            double _stats_max_error;
+
+            Uint64 get_period() const;
+            void record_error(double error);
+
+        public:
+            frame_pacer();
+            ~frame_pacer() = default;
+
+            // Frames per second to pace to. Zero or less runs uncapped.
+            int target_fps = 60;
+            // Remaining time (in seconds) below which the pacer stops sleeping and busy waits instead.
+            double spin_threshold = 0.002;
+
+            void reset();
+            double wait();
+
+            frame_pacing_stats get_stats() const;
+            void reset_stats();
+    };
+}
+
+#endif
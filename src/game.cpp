@@ -1,4 +1,7 @@
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -6,25 +9,67 @@
 #include <lua/lua.h>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
+#include "animation.h"
+#include "dirty_rects.h"
 #include "ecs.h"
+#include "flow_field.h"
+#include "frame_pacer.h"
 #include "game.h"
 #include "io.h"
+#include "job_system.h"
 #include "logger.h"
+#include "pathfinding.h"
+#include "projectile_pool.h"
+#include "render_frame.h"
 #include "resources.h"
-#include "util.h"
+#include "solidity_grid.h"
+#include "tilemap.h"
+#include "./components/animation_component.h"
+#include "./components/box_collider_component.h"
+#include "./components/camera_component.h"
+#include "./components/fixed_body_component.h"
+#include "./components/flow_field_component.h"
 #include "./components/rigidbody_component.h"
 #include "./components/transform_component.h"
 #include "./components/sprite_component.h"
+#include "./components/steering_component.h"
+#include "./systems/animation_system.h"
+#include "./systems/camera_system.h"
+#include "./systems/collision_system.h"
+#include "./systems/deterministic_movement_system.h"
+#include "./systems/flow_field_system.h"
 #include "./systems/render_system.h"
 #include "./systems/movement_system.h"
+#include "./systems/steering_system.h"
 
 engine::game::game()
 {
     target_fps = 60;
     _is_running = false;
-    _ms_prev_frame = get_ms_per_frame();
+    _delta_time = 0.0;
+    _accumulator = 0.0;
+    _interpolation_alpha = 1.0;
+    _tick = 0;
+    _world_checksum = 0;
+    _projectile_texture = resources::INVALID_TEXTURE;
+    _window = nullptr;
+    _renderer = nullptr;
+    _surface = nullptr;
+    _frame_count = 0;
+    _is_software_renderer = false;
+    _presented_zoom = 0.0f;
+    window_width = 1280;
+    window_height = 720;
+    _write_snapshot = 0;
+    _has_snapshot = false;
+    _is_presenting = false;
 
     _registry = std::make_unique<ecs::registry>();
+    _job_system = std::make_unique<job_system>();
+    _navigation_graph = std::make_unique<navigation::hierarchical_graph>(&_solidity_grid);
+    _pathfinder = std::make_unique<navigation::pathfinder>(&_solidity_grid, _job_system.get());
+    _pathfinder->set_hierarchical_graph(_navigation_graph.get());
+    _flow_fields = std::make_unique<navigation::flow_field_cache>(&_solidity_grid);
 
     logger::log("Game constructor invoked.");
 }
@@ -34,13 +79,48 @@ engine::game::~game()
     logger::log("Game destructor invoked.");
 }
 
-int engine::game::get_ms_per_frame()
+double engine::game::get_fixed_delta_time()
 {
-    return 1000 / target_fps;
+    return 1.0 / tick_rate;
 }
 
 void engine::game::initialize()
 {
+    if (headless)
+    {
+        // The dummy driver needs no display. Only the subsystems a frame needs are started, as the rest
+        // (audio, controllers) may be missing on build machines.
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+        if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_EVENTS) != 0)
+        {
+            logger::error("Error initializing SDL.");
+            return;
+        }
+
+        logger::log("SDL Initialized without a display.");
+
+        // Draw into an offscreen surface with the software renderer instead of a window.
+        _surface = SDL_CreateRGBSurfaceWithFormat(0, window_width, window_height, 32, SDL_PIXELFORMAT_ARGB8888);
+        if (!_surface)
+        {
+            logger::error("Error creating offscreen surface.");
+            return;
+        }
+
+        _renderer = SDL_CreateSoftwareRenderer(_surface);
+        if (!_renderer)
+        {
+            logger::error("Error creating SDL software renderer.");
+            return;
+        }
+
+        logger::log("Offscreen renderer created.");
+
+        _is_software_renderer = true;
+        _is_running = true;
+        return;
+    }
+
     // Initialize SDL.
     if (SDL_Init(SDL_INIT_EVERYTHING) != 0)
     {
@@ -97,6 +177,9 @@ void engine::game::initialize()
 
     logger::log("Renderer created.");
 
+    SDL_RendererInfo renderer_info;
+    _is_software_renderer = SDL_GetRendererInfo(_renderer, &renderer_info) == 0 && (renderer_info.flags & SDL_RENDERER_SOFTWARE) != 0;
+
     _is_running = true;
 }
 
@@ -104,81 +187,357 @@ void engine::game::run()
 {
     load_level(1);
     setup();
+
+    // Start pacing after loading so the first frame doesn't count the load time.
+    _frame_pacer.reset();
+    if (threaded_simulation)
+    {
+        _simulation_thread = std::thread(&game::run_simulation, this);
+        while (_is_running)
+        {
+            process_input();
+            enforce_frame_rate();
+            // Passes before the first snapshot arrives present nothing, so they aren't frames.
+            if (present_latest())
+            {
+                count_frame();
+            }
+        }
+
+        _simulation_thread.join();
+        return;
+    }
+
     while (_is_running)
     {
         process_input();
         enforce_frame_rate();
-        update();
+        step_simulation(_delta_time);
         render();
+        count_frame();
     }
 }
 
+void engine::game::run_simulation()
+{
+    // Tick on our own clock, independent of the frame rate.
+    _tick_pacer.target_fps = tick_rate;
+    _tick_pacer.reset();
+    while (_is_running)
+    {
+        const double elapsed_time = _tick_pacer.wait();
+        if (step_simulation(elapsed_time) > 0)
+        {
+            // Frames show the latest tick as is, so there is nothing to interpolate.
+            capture_snapshot(_snapshots[_write_snapshot], 1.0);
+            publish_snapshot();
+        }
+    }
+}
+
+void engine::game::capture_snapshot(frame_snapshot& snapshot, double alpha)
+{
+    systems::camera_system& camera_system = _registry->get_system<systems::camera_system>();
+    camera_system.update(alpha);
+    const components::camera_component* camera = camera_system.get_camera();
+
+    snapshot.view = camera ? camera->view : physics::aabb(glm::vec2(0.0f, 0.0f), glm::vec2(window_width, window_height));
+    snapshot.zoom = camera ? camera->zoom : 1.0f;
+    snapshot.tick = _tick;
+
+    _registry->get_system<systems::render_system>().build(snapshot.sprites, alpha, camera);
+
+    // Projectiles go on top of every sprite, in a batch of their own.
+    _projectiles.build(
+        snapshot.sprites,
+        255,
+        resources::get_texture_region(_projectile_texture),
+        4,
+        static_cast<float>(alpha),
+        static_cast<float>(get_fixed_delta_time()),
+        snapshot.view,
+        snapshot.zoom
+    );
+}
+
+void engine::game::publish_snapshot()
+{
+    // Wait until the main thread is done with the snapshot we are about to hand over the other one for.
+    std::unique_lock<std::mutex> lock(_snapshot_mutex);
+    _snapshot_released.wait(lock, [this]() { return !_is_presenting; });
+    _write_snapshot = 1 - _write_snapshot;
+    _has_snapshot = true;
+
+    _published_tile_edits.insert(_published_tile_edits.end(), _pending_tile_edits.begin(), _pending_tile_edits.end());
+    _pending_tile_edits.clear();
+}
+
+void engine::game::present(const frame_snapshot& snapshot)
+{
+    // Only chunks whose tiles changed are baked again.
+    const int baked_chunks = _tilemap.bake_dirty(_renderer);
+    systems::render_system& render_system = _registry->get_system<systems::render_system>();
+
+    bool is_partial = false;
+    if (_is_software_renderer)
+    {
+        // Scrolling, zooming or new ground changes every pixel, so only sprite changes can be redrawn in part.
+        if (baked_chunks > 0 || snapshot.view.min != _presented_view.min || snapshot.view.max != _presented_view.max || snapshot.zoom != _presented_zoom)
+        {
+            _dirty_rects.invalidate();
+        }
+
+        is_partial = _dirty_rects.update(snapshot.sprites, window_width, window_height);
+        _presented_view = snapshot.view;
+        _presented_zoom = snapshot.zoom;
+    }
+
+    SDL_SetRenderDrawColor(_renderer, 21, 21, 21, SDL_ALPHA_OPAQUE);
+    if (is_partial)
+    {
+        // Restore the background and ground under each dirty rectangle, then draw the sprites clipped to them.
+        const std::vector<SDL_Rect>& dirty_rects = _dirty_rects.get_rects();
+        for (const SDL_Rect& rect: dirty_rects)
+        {
+            SDL_RenderSetClipRect(_renderer, &rect);
+            SDL_RenderFillRect(_renderer, &rect);
+            _tilemap.render(_renderer, snapshot.view, snapshot.zoom);
+        }
+        SDL_RenderSetClipRect(_renderer, nullptr);
+
+        render_system.submit(_renderer, snapshot.sprites, &dirty_rects);
+    }
+    else
+    {
+        // Draw background. The ground goes below every sprite.
+        SDL_RenderClear(_renderer);
+        _tilemap.render(_renderer, snapshot.view, snapshot.zoom);
+        render_system.submit(_renderer, snapshot.sprites);
+    }
+
+    // Swap back buffer with front buffer.
+    SDL_RenderPresent(_renderer);
+}
+
+// Presents the most recently published snapshot. Returns false if there is none yet.
+bool engine::game::present_latest()
+{
+    int read_snapshot;
+    {
+        std::lock_guard<std::mutex> lock(_snapshot_mutex);
+        if (!_has_snapshot)
+        {
+            return false;
+        }
+
+        _is_presenting = true;
+        read_snapshot = 1 - _write_snapshot;
+        _applying_tile_edits.swap(_published_tile_edits);
+    }
+
+    for (const tile_edit& edit: _applying_tile_edits)
+    {
+        _tilemap.set_tile(edit.x, edit.y, edit.tile_index);
+    }
+    _applying_tile_edits.clear();
+
+    // The simulation only ever writes the other snapshot, so this one can be drawn without holding the lock.
+    present(_snapshots[read_snapshot]);
+
+    {
+        std::lock_guard<std::mutex> lock(_snapshot_mutex);
+        _is_presenting = false;
+    }
+    _snapshot_released.notify_one();
+    return true;
+}
+
 void engine::game::load_level(int level)
 {
     // Load textures from Resources.
     resources::load_texture(_renderer, "jungle-tileset", "./assets/tilemaps/jungle.png");
     resources::load_texture(_renderer, "tank-image", "./assets/images/tank-panther-right.png");
     resources::load_texture(_renderer, "truck-image", "./assets/images/truck-ford-right.png");
+    resources::load_texture(_renderer, "tree-image", "./assets/images/tree.png");
+    resources::load_texture(_renderer, "bullet-image", "./assets/images/bullet.png");
+    _projectile_texture = resources::get_texture_handle("bullet-image");
+    resources::load_texture(_renderer, "chopper-image", "./assets/images/chopper-spritesheet.png");
+    resources::load_texture(_renderer, "radar-image", "./assets/images/radar.png");
+
+    // Setup animation clips. The chopper sheet has a row of two rotor frames per direction: up, right, down, left.
+    const int chopper_right_clip = _animations.add_strip(0, 32, 32, 32, 2, 15.0f);
+    const int radar_clip = _animations.add_strip(0, 0, 64, 64, 8, 8.0f);
+    resources::load_texture(_renderer, "landing-base-image", "./assets/images/landing-base.png");
+    resources::load_texture(_renderer, "takeoff-base-image", "./assets/images/takeoff-base.png");
 
     // Add systems.
     _registry->add_system<systems::render_system>();
     _registry->add_system<systems::movement_system>();
+    _registry->add_system<systems::deterministic_movement_system>();
+    _registry->add_system<systems::collision_system>();
+    _registry->add_system<systems::flow_field_system>();
+    _registry->add_system<systems::steering_system>();
+    _registry->add_system<systems::camera_system>();
+    _registry->add_system<systems::animation_system>();
+
+    // Systems that don't need to run every tick are given an update rate here. Movement isn't one of them, as
+    // interpolation needs positions to advance every tick. Steering and animation only run on the ticks they are
+    // due, with the time since their last run; flow field velocities are refreshed for a quarter of their entities
+    // each tick instead.
+    _registry->set_system_update_rate<systems::steering_system>(20.0, tick_rate);
+    _registry->set_system_update_rate<systems::animation_system>(30.0, tick_rate);
+    _registry->set_system_update_rate<systems::flow_field_system>(tick_rate / 4.0, tick_rate);
 
     // Generate tile map.
-    std::string path = "./assets/tilemaps/jungle.map";
-    std::vector<std::string> contents = io::read_all_lines(path);
-    int contents_size = static_cast<int>(contents.size());
-    for (int row = 0; row < contents_size; row++) // Read "rows"/lines of file.
-    {
-        std::vector<std::string> results = util::str_split(contents[row], ',');
-        int results_size = static_cast<int>(results.size());
-        for (int column = 0; column < results_size; column++) // Read "columns"/every item in line delimited by comma.
-        {
-            // Define constant data based on tilemap photo.
-            // TODO: Add a way for these value to be either decided automatically, or tweaked within a config file.
-            const int tile_size = 32;
-            const int tilemap_cols = 10;
-            const int tilemap_rows = 3;
-
-            // Find the x and y index of the tile, relative to the tilemap image size.
-            const int tile_index = atoi(results[column].c_str());
-            int x_index = tile_index % tilemap_cols;
-            int y_index = 0;
-            for (int i = 0; i < tilemap_rows; i++)
-            {
-                int smallest_col = i * tilemap_cols;
-                int biggest_col = smallest_col + (tilemap_cols - 1);
-                if (!(tile_index < smallest_col) && !(tile_index > biggest_col))
-                {
-                    y_index = i;
-                    break;
-                }
-            }
+    // Define constant data based on tilemap photo.
+    // TODO: Add a way for these value to be either decided automatically, or tweaked within a config file.
+    const int tile_size = 32;
+    const int tilemap_cols = 10;
+
+    const std::vector<std::vector<int>> tiles = io::read_tile_map("./assets/tilemaps/jungle.map");
+
+    // The solidity grid sizes itself to the widest row of the map.
+    _solidity_grid.load_tiles(tiles, tile_size, physics::JUNGLE_BLOCKING_TILES);
+    const int map_width = _solidity_grid.get_width();
+    const int map_height = _solidity_grid.get_height();
+    _tilemap.resize(map_width, map_height, tile_size, "jungle-tileset", tilemap_cols);
+    _registry->get_system<systems::deterministic_movement_system>().set_world_bounds(
+        fixed_vec2(),
+        fixed_vec2(fixed::from_int(map_width * tile_size), fixed::from_int(map_height * tile_size))
+    );
 
-            // Create tile entity.
-            // The tile x and y index are multipled by the tile size to offset the srcRect of jungle-tileset.
-            ecs::entity tile = _registry->create_entity();
-            tile.add_component<components::transform_component>(glm::vec2(column * tile_size, row * tile_size), glm::vec2(1.0f, 1.0f), 0.0);
-            tile.add_component<components::sprite_component>("jungle-tileset", tile_size, tile_size, x_index * tile_size, y_index * tile_size);
+    for (int row = 0; row < map_height; row++)
+    {
+        for (int column = 0; column < static_cast<int>(tiles[row].size()); column++)
+        {
+            _tilemap.set_tile(column, row, tiles[row][column]);
         }
     }
 
+    // Setup static obstacles.
+    const glm::vec2 tree_positions[] = {
+        glm::vec2(264.0f, 192.0f),
+        glm::vec2(296.0f, 200.0f),
+        glm::vec2(232.0f, 288.0f),
+        glm::vec2(392.0f, 256.0f),
+        glm::vec2(424.0f, 264.0f),
+        glm::vec2(680.0f, 96.0f)
+    };
+    for (const glm::vec2& position: tree_positions)
+    {
+        ecs::entity tree = _registry->create_entity();
+        tree.add_component<components::transform_component>(position, glm::vec2(1.0f, 1.0f), 0.0);
+        tree.add_component<components::sprite_component>("tree-image", 16, 32, 0, 0, 3, true);
+        tree.add_component<components::box_collider_component>(16, 32, glm::vec2(0.0f, 0.0f), true);
+    }
+
+    ecs::entity landing_base = _registry->create_entity();
+    landing_base.add_component<components::transform_component>(glm::vec2(448.0f, 384.0f), glm::vec2(1.0f, 1.0f), 0.0);
+    landing_base.add_component<components::sprite_component>("landing-base-image", 32, 32, 0, 0, 1, true);
+    landing_base.add_component<components::box_collider_component>(32, 32, glm::vec2(0.0f, 0.0f), true);
+
+    ecs::entity takeoff_base = _registry->create_entity();
+    takeoff_base.add_component<components::transform_component>(glm::vec2(576.0f, 352.0f), glm::vec2(1.0f, 1.0f), 0.0);
+    takeoff_base.add_component<components::sprite_component>("takeoff-base-image", 32, 32, 0, 0, 1, true);
+    takeoff_base.add_component<components::box_collider_component>(32, 32, glm::vec2(0.0f, 0.0f), true);
+
     // Setup tank entity.
     ecs::entity tank = _registry->create_entity();
-    tank.add_component<components::transform_component>(glm::vec2(10.0f, 10.0f), glm::vec2(1.0f, 1.0f), 0.0);
+    tank.add_component<components::transform_component>(glm::vec2(64.0f, 224.0f), glm::vec2(1.0f, 1.0f), 0.0);
     tank.add_component<components::rigidbody_component>(glm::vec2(50.0f, 0.0f));
-    tank.add_component<components::sprite_component>("tank-image", 32, 32);
+    tank.add_component<components::sprite_component>("tank-image", 32, 32, 0, 0, 2);
+    tank.add_component<components::box_collider_component>(32, 32);
+    tank.add_component<components::flow_field_component>(glm::ivec2(17, 11), 50.0f, glm::vec2(16.0f, 16.0f));
+    tank.add_component<components::steering_component>(48.0f, 60.0f, glm::vec2(16.0f, 16.0f));
+    if (deterministic)
+    {
+        tank.add_component<components::fixed_body_component>(glm::vec2(64.0f, 224.0f), glm::vec2(50.0f, 0.0f));
+    }
 
     // Setup truck entity.
     ecs::entity truck = _registry->create_entity();
-    truck.add_component<components::transform_component>(glm::vec2(10.0f, 50.0f), glm::vec2(1.0f, 1.0f), 90.0);
+    truck.add_component<components::transform_component>(glm::vec2(320.0f, 288.0f), glm::vec2(1.0f, 1.0f), 90.0);
     truck.add_component<components::rigidbody_component>(glm::vec2(0.0f, 20.0f));
-    truck.add_component<components::sprite_component>("truck-image", 32, 32);
+    truck.add_component<components::sprite_component>("truck-image", 32, 32, 0, 0, 2);
+    truck.add_component<components::box_collider_component>(32, 32);
+    truck.add_component<components::steering_component>(48.0f, 40.0f, glm::vec2(16.0f, 16.0f));
+    if (deterministic)
+    {
+        truck.add_component<components::fixed_body_component>(glm::vec2(320.0f, 288.0f), glm::vec2(0.0f, 20.0f));
+    }
+
+    // Setup bullet entity. It moves several pixels per tick, so it's swept to stop at the tree instead of tunneling through.
+    ecs::entity bullet = _registry->create_entity();
+    bullet.add_component<components::transform_component>(glm::vec2(200.0f, 205.0f), glm::vec2(1.0f, 1.0f), 0.0);
+    bullet.add_component<components::rigidbody_component>(glm::vec2(600.0f, 0.0f));
+    bullet.add_component<components::sprite_component>("bullet-image", 4, 4, 0, 0, 2);
+    bullet.add_component<components::box_collider_component>(4, 4, glm::vec2(0.0f, 0.0f), false, true);
+    if (deterministic)
+    {
+        bullet.add_component<components::fixed_body_component>(glm::vec2(200.0f, 205.0f), glm::vec2(600.0f, 0.0f));
+    }
+
+    // Setup animated entities.
+    ecs::entity chopper = _registry->create_entity();
+    chopper.add_component<components::transform_component>(glm::vec2(32.0f, 96.0f), glm::vec2(1.0f, 1.0f), 0.0);
+    chopper.add_component<components::rigidbody_component>(glm::vec2(40.0f, 0.0f));
+    chopper.add_component<components::sprite_component>("chopper-image", 32, 32, 0, 32, 4);
+    chopper.add_component<components::animation_component>(chopper_right_clip);
+    if (deterministic)
+    {
+        chopper.add_component<components::fixed_body_component>(glm::vec2(32.0f, 96.0f), glm::vec2(40.0f, 0.0f));
+    }
+
+    ecs::entity radar = _registry->create_entity();
+    radar.add_component<components::transform_component>(glm::vec2(704.0f, 544.0f), glm::vec2(1.0f, 1.0f), 0.0);
+    radar.add_component<components::sprite_component>("radar-image", 64, 64, 0, 0, 4, true);
+    radar.add_component<components::animation_component>(radar_clip);
+
+    // Setup camera entity. It follows the tank and stays over the map.
+    ecs::entity camera = _registry->create_entity();
+    camera.add_component<components::transform_component>(glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 1.0f), 0.0);
+    camera.add_component<components::camera_component>(
+        glm::vec2(window_width, window_height),
+        2.0f,
+        glm::vec2(0.0f, 0.0f),
+        glm::vec2(map_width * tile_size, map_height * tile_size),
+        tank.get_id(),
+        glm::vec2(16.0f, 16.0f)
+    );
+
+    // Process the new entities now so the static collision hierarchy can be built from them.
+    _registry->update();
+    _registry->get_system<systems::collision_system>().build_static();
+    _registry->get_system<systems::collision_system>().set_tile_grid(&_solidity_grid);
+    _navigation_graph->build();
+    _registry->get_system<systems::flow_field_system>().set_field_cache(_flow_fields.get());
+    _registry->get_system<systems::animation_system>().set_library(&_animations);
+    _registry->get_system<systems::steering_system>().set_job_system(_job_system.get());
+    _registry->get_system<systems::steering_system>().set_tile_grid(&_solidity_grid);
 }
 
 void engine::game::setup()
 {
+    // Fire a ring of projectiles from the landing base.
+    const int projectile_count = 32;
+    for (int i = 0; i < projectile_count; i++)
+    {
+        const float angle = 6.28318531f * i / projectile_count;
+        _projectiles.spawn(glm::vec2(462.0f, 398.0f), glm::vec2(std::cos(angle), std::sin(angle)) * 150.0f, 1.5f);
+    }
 
+    // Plot a route for the tank to the takeoff base. The result arrives on a later tick.
+    _pathfinder->request_path(glm::ivec2(2, 7), glm::ivec2(18, 11), [](const navigation::path_result& result)
+    {
+        if (result.found)
+        {
+            logger::log("Path " + std::to_string(result.request_id) + " found with " + std::to_string(result.path->size()) + " tiles.");
+        }
+        else
+        {
+            logger::warn("Path " + std::to_string(result.request_id) + " not found.");
+        }
+    });
 }
 
 void engine::game::process_input()
@@ -198,50 +557,179 @@ void engine::game::process_input()
                     _is_running = false;
                 }
                 break;
+
+            case SDL_EventType::SDL_RENDER_TARGETS_RESET:
+            case SDL_EventType::SDL_RENDER_DEVICE_RESET:
+                // The baked tilemap chunks were lost with the renderer's target textures.
+                _tilemap.mark_all_dirty();
+                break;
         }
     }
 }
 
 void engine::game::enforce_frame_rate()
 {
-    // If we are running too fast, waste some time until we reach miliseconds per frame.
-    Uint32 time_to_wait = get_ms_per_frame() - (SDL_GetTicks() - _ms_prev_frame);
-    if (time_to_wait > 0 && time_to_wait <= _ms_prev_frame)
+    // If we are running too fast, waste some time until the next frame is due.
+    _frame_pacer.target_fps = target_fps;
+    _delta_time = _frame_pacer.wait();
+}
+
+void engine::game::count_frame()
+{
+    _frame_count++;
+    if (max_frames > 0 && _frame_count >= static_cast<unsigned long long>(max_frames))
     {
-        SDL_Delay(time_to_wait);
+        _is_running = false;
+    }
+}
+
+int engine::game::step_simulation(double elapsed_time)
+{
+    const double fixed_delta_time = get_fixed_delta_time();
+
+    // Run as many fixed ticks as the elapsed time covers, up to the catch-up limit.
+    _accumulator += elapsed_time;
+    int steps = 0;
+    while (_accumulator >= fixed_delta_time && steps < max_catch_up_steps)
+    {
+        update();
+        _accumulator -= fixed_delta_time;
+        steps++;
     }
 
-    // Calculate the number of seconds since the last frame.
-    _delta_time = (SDL_GetTicks() - _ms_prev_frame) / 1000.0;
+    // If we fell too far behind, drop the remaining time instead of trying to catch up on the next frame.
+    if (_accumulator >= fixed_delta_time)
+    {
+        _accumulator = std::fmod(_accumulator, fixed_delta_time);
+    }
 
-    // Store "previous" frame time.
-    _ms_prev_frame = SDL_GetTicks();
+    _interpolation_alpha = _accumulator / fixed_delta_time;
+    return steps;
 }
 
 void engine::game::update()
 {
-    // Update systems.
-    _registry->get_system<systems::movement_system>().update(_delta_time);
+    const double fixed_delta_time = get_fixed_delta_time();
+
+    // Deliver paths that finished since the last tick.
+    _pathfinder->dispatch_completed();
+
+    // Update systems that are due this tick.
+    if (deterministic)
+    {
+        // The fixed point tick is derived with integer math so every machine agrees on it.
+        systems::deterministic_movement_system& movement_system = _registry->get_system<systems::deterministic_movement_system>();
+        movement_system.update(fixed::from_ratio(1, tick_rate));
+        _world_checksum = movement_system.get_checksum();
+    }
+    else
+    {
+        // Flow fields only steer the floating point simulation.
+        _registry->get_system<systems::flow_field_system>().update(_tick);
+
+        systems::steering_system& steering_system = _registry->get_system<systems::steering_system>();
+        if (steering_system.is_update_due(_tick))
+        {
+            steering_system.update(steering_system.get_update_delta_time(fixed_delta_time));
+        }
+
+        _registry->get_system<systems::movement_system>().update(fixed_delta_time);
+    }
+
+    _registry->get_system<systems::collision_system>().update();
+    _projectiles.update(static_cast<float>(fixed_delta_time));
+
+    systems::animation_system& animation_system = _registry->get_system<systems::animation_system>();
+    if (animation_system.is_update_due(_tick))
+    {
+        animation_system.update(animation_system.get_update_delta_time(fixed_delta_time));
+    }
 
     // Update registry to process pending entities.
     _registry->update();
+
+    _tick++;
 }
 
 void engine::game::render()
 {
-    // Draw background.
-    SDL_SetRenderDrawColor(_renderer, 21, 21, 21, SDL_ALPHA_OPAQUE);
-    SDL_RenderClear(_renderer);
+    for (const tile_edit& edit: _pending_tile_edits)
+    {
+        _tilemap.set_tile(edit.x, edit.y, edit.tile_index);
+    }
+    _pending_tile_edits.clear();
 
-    _registry->get_system<systems::render_system>().update(_renderer);
+    capture_snapshot(_snapshots[0], _interpolation_alpha);
+    present(_snapshots[0]);
+}
 
-    // Swap back buffer with front buffer.
-    SDL_RenderPresent(_renderer);
+/**
+ * Changes a tile of the ground from the simulation. The change shows up with the next presented frame, and only
+ * the tile's chunk is baked again. Solidity is separate; update the solidity grid as well if needed.
+ */
+void engine::game::set_tile(int x, int y, int tile_index)
+{
+    _pending_tile_edits.push_back({ x, y, tile_index });
+}
+
+uint64_t engine::game::get_world_checksum() const
+{
+    return _world_checksum;
 }
 
 void engine::game::destroy()
 {
-    SDL_DestroyRenderer(_renderer);
-    SDL_DestroyWindow(_window);
+    // Let background jobs finish before anything they use goes away.
+    _job_system->wait();
+
+    const frame_pacing_stats stats = _frame_pacer.get_stats();
+    logger::log(
+        "Frame pacing: " + std::to_string(stats.frames) + " frames, " +
+        std::to_string(stats.missed_frames) + " missed, mean error " +
+        std::to_string(stats.mean_error * 1000.0) + "ms, standard deviation " +
+        std::to_string(stats.error_std_dev * 1000.0) + "ms, max error " +
+        std::to_string(stats.max_error * 1000.0) + "ms."
+    );
+
+    const systems::render_stats render_stats = _registry->get_system<systems::render_system>().get_stats();
+    if (render_stats.frames > 0)
+    {
+        logger::log(
+            "Rendering: " + std::to_string(render_stats.draw_calls / static_cast<double>(render_stats.frames)) + " draw calls and " +
+            std::to_string(render_stats.sprites / static_cast<double>(render_stats.frames)) + " sprites per frame on average."
+        );
+    }
+
+    const dirty_rect_stats dirty_stats = _dirty_rects.get_stats();
+    const unsigned long long partial_frames = dirty_stats.frames - dirty_stats.full_frames;
+    if (partial_frames > 0)
+    {
+        logger::log(
+            "Dirty rectangles: " + std::to_string(partial_frames) + " of " + std::to_string(dirty_stats.frames) +
+            " frames redrawn in part, with " + std::to_string(dirty_stats.dirty_pixels / static_cast<double>(partial_frames)) +
+            " dirty pixels on average."
+        );
+    }
+
+    if (deterministic)
+    {
+        logger::log("Deterministic simulation ended on tick " + std::to_string(_tick) + " with checksum " + std::to_string(_world_checksum) + ".");
+    }
+
+    // Chunk textures belong to the renderer, so they have to go first.
+    _tilemap.clear();
+
+    if (_renderer)
+    {
+        SDL_DestroyRenderer(_renderer);
+    }
+    if (_window)
+    {
+        SDL_DestroyWindow(_window);
+    }
+    if (_surface)
+    {
+        SDL_FreeSurface(_surface);
+    }
     SDL_Quit();
 }
@@ -1,30 +1,140 @@
 #ifndef ENGINE_GAME_H
 #define ENGINE_GAME_H
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include <SDL2/SDL.h>
+#include "aabb.h"
+#include "animation.h"
+#include "dirty_rects.h"
 #include "ecs.h"
+#include "flow_field.h"
+#include "frame_pacer.h"
+#include "hierarchical_graph.h"
+#include "job_system.h"
+#include "pathfinding.h"
+#include "projectile_pool.h"
+#include "render_frame.h"
+#include "resources.h"
+#include "solidity_grid.h"
+#include "tilemap.h"
 
 namespace engine
 {
+    /**
+     * What the simulation hands to the renderer: one frame's sprites, ready to submit, and the view they were
+     * built for. Holds no references into the world, so it can be drawn while the next tick runs.
+     */
+    struct frame_snapshot
+    {
+        render_frame sprites;
+        physics::aabb view;
+        float zoom = 1.0f;
+        unsigned long long tick = 0;
+    };
+
+    // A change to one tile of the ground, made by the simulation and applied by the renderer.
+    struct tile_edit
+    {
+        int x;
+        int y;
+        int tile_index;
+    };
+
     class game
     {
         private:
-            bool _is_running;
-            Uint32 _ms_prev_frame;
+            std::atomic<bool> _is_running;
             double _delta_time;
 
+            // Unsimulated time carried over between frames, consumed in fixed-size ticks.
+            double _accumulator;
+            // How far the current frame is between the previous tick and the latest one (0 to 1).
+            double _interpolation_alpha;
+            // Number of simulation ticks run so far.
+            unsigned long long _tick;
+            // Checksum of the simulated world after the most recent tick. Only produced in deterministic mode.
+            uint64_t _world_checksum;
+
             SDL_Window* _window;
             SDL_Renderer* _renderer;
+            // Offscreen target of the software renderer in headless mode.
+            SDL_Surface* _surface;
+            // Number of frames presented so far.
+            unsigned long long _frame_count;
+
+            // The software renderer keeps its back buffer between frames, so only what changed is redrawn.
+            bool _is_software_renderer;
+            dirty_rect_tracker _dirty_rects;
+            physics::aabb _presented_view;
+            float _presented_zoom;
 
             std::unique_ptr<ecs::registry> _registry;
 
-            int get_ms_per_frame();
+            frame_pacer _frame_pacer;
+
+            // Ground tiles of the current level, and which of them block movement.
+            tilemap _tilemap;
+            physics::solidity_grid _solidity_grid;
+
+            std::unique_ptr<job_system> _job_system;
+            std::unique_ptr<navigation::hierarchical_graph> _navigation_graph;
+            std::unique_ptr<navigation::pathfinder> _pathfinder;
+            std::unique_ptr<navigation::flow_field_cache> _flow_fields;
+
+            animation_library _animations;
+            projectile_pool _projectiles;
+            resources::texture_handle _projectile_texture;
+
+            // Snapshots shared with the simulation thread. The simulation writes one while the other is presented.
+            frame_snapshot _snapshots[2];
+            int _write_snapshot;
+            bool _has_snapshot;
+            bool _is_presenting;
+            std::mutex _snapshot_mutex;
+            std::condition_variable _snapshot_released;
+
+            // The tilemap belongs to the renderer. Tile edits made by the simulation wait in _pending_tile_edits,
+            // are handed over with the next published snapshot, and are applied just before it is presented.
+            std::vector<tile_edit> _pending_tile_edits;
+            std::vector<tile_edit> _published_tile_edits;
+            std::vector<tile_edit> _applying_tile_edits;
+            std::thread _simulation_thread;
+            frame_pacer _tick_pacer;
+
+            double get_fixed_delta_time();
+            void run_simulation();
+            void capture_snapshot(frame_snapshot& snapshot, double alpha);
+            void publish_snapshot();
+            void present(const frame_snapshot& snapshot);
+            bool present_latest();
 
         public:
             game();
             ~game();
 
+            // Frames per second to render at. Zero or less runs uncapped.
             int target_fps = 60;
+            // Number of simulation ticks per second. May be lower than target_fps; rendering interpolates between ticks.
+            int tick_rate = 60;
+            // Maximum ticks simulated in a single frame. Prevents a spiral of death when ticks take longer than they simulate.
+            int max_catch_up_steps = 5;
+            // Simulate with fixed point math so runs are bit-exact across machines, for lockstep sessions and replays.
+            bool deterministic = false;
+            // Run the simulation on its own thread, handing frame snapshots to the main thread, which keeps
+            // input, rendering and presenting. Frames show the latest tick instead of interpolating between two.
+            // Anything the simulation touches (including path callbacks) must stay on its thread, and tiles change
+            // only through set_tile().
+            bool threaded_simulation = false;
+            // Run without a display: SDL's dummy video driver and a software renderer drawing into an offscreen
+            // surface of window_width by window_height. Everything still renders, so full frames can be profiled.
+            bool headless = false;
+            // Stop after this many frames. Zero or less runs until quit.
+            int max_frames = 0;
             int window_width;
             int window_height;
 
@@ -35,10 +145,15 @@ namespace engine
             void setup();
             void process_input();
             void enforce_frame_rate();
+            void count_frame();
+            int step_simulation(double elapsed_time);
             void update();
             void render();
+            void set_tile(int x, int y, int tile_index);
 
             void destroy();
+
+            uint64_t get_world_checksum() const;
     };
 }
 
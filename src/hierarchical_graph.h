@@ -0,0 +1,76 @@
+#ifndef ENGINE_HIERARCHICALGRAPH_H
+#define ENGINE_HIERARCHICALGRAPH_H
+
+#include <vector>
+#include <glm/vec2.hpp>
+#include "pathfinding.h"
+#include "solidity_grid.h"
+
+namespace engine::navigation
+{
+    /**
+     * Abstract graph for hierarchical pathfinding (HPA*) over a solidity grid.
+     *
+     * The grid is split into square clusters. Wherever two neighbouring clusters share a run of open tiles along
+     * their border, the run becomes an entrance with a node on each side. Distances between the nodes inside each
+     * cluster are precomputed, so a long path is first planned over this small graph and only then refined tile by
+     * tile between consecutive nodes.
+     *
+     * When tiles change, only their clusters (plus the neighbours sharing a changed border) are rebuilt. update()
+     * finds the changed tiles itself by comparing the grid against the solidity it was last built from.
+     * Queries are read only and safe to run from several threads, as long as nothing is rebuilt meanwhile.
+     */
+    class hierarchical_graph
+    {
+        private:
+            struct cluster
+            {
+                std::vector<glm::ivec2> nodes;
+                // Shortest distance between each pair of nodes inside the cluster (nodes x nodes), negative if unreachable.
+                std::vector<float> distances;
+                bool is_dirty = true;
+                bool is_border_dirty = true;
+            };
+
+            const physics::solidity_grid* _grid;
+            int _cluster_size;
+            int _clusters_x;
+            int _clusters_y;
+            std::vector<cluster> _clusters;
+
+            // Entrance tiles, as offsets along the border: between cluster (x, y) and (x + 1, y), and (x, y) and (x, y + 1).
+            std::vector<std::vector<int>> _vertical_borders;
+            std::vector<std::vector<int>> _horizontal_borders;
+
+            // Solidity of every tile, and the grid version, as of the last build.
+            std::vector<bool> _built_solidity;
+            unsigned int _built_version;
+
+            int get_cluster_index(int cluster_x, int cluster_y) const;
+            void build_vertical_border(int cluster_x, int cluster_y);
+            void build_horizontal_border(int cluster_x, int cluster_y);
+            void build_cluster(int cluster_x, int cluster_y);
+            void get_cluster_distances(int cluster_index, glm::ivec2 source, std::vector<float>& distances) const;
+            void record_solidity();
+
+        public:
+            // Entrances longer than this get a node at each end instead of one in the middle.
+            static const int MAX_SINGLE_NODE_ENTRANCE = 6;
+
+            hierarchical_graph(const physics::solidity_grid* grid, int cluster_size = 10);
+            ~hierarchical_graph() = default;
+
+            int get_cluster_size() const;
+            int get_node_count() const;
+
+            void build();
+            void mark_tile_changed(int x, int y);
+            int rebuild_dirty();
+            bool is_out_of_date() const;
+            int update();
+
+            bool find_path(search_context& context, glm::ivec2 start, glm::ivec2 goal, tile_path& path) const;
+    };
+}
+
+#endif
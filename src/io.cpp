@@ -1,7 +1,9 @@
+#include <cstdlib>
 #include <fstream>
 #include <string>
 #include <vector>
 #include "io.h"
+#include "util.h"
 
 // Reads content of file and returns as string.
 std::string engine::io::read(const std::string& path)
@@ -25,3 +27,19 @@ std::vector<std::string> engine::io::read_all_lines(const std::string& path)
     }
     return lines;
 }
+
+// Reads a tile map of comma separated tile indices, one row per line. Rows may differ in length.
+std::vector<std::vector<int>> engine::io::read_tile_map(const std::string& path)
+{
+    std::vector<std::vector<int>> tiles;
+    for (const std::string& line: read_all_lines(path))
+    {
+        std::vector<int> row;
+        for (const std::string& item: util::str_split(line, ','))
+        {
+            row.push_back(atoi(item.c_str()));
+        }
+        tiles.push_back(row);
+    }
+    return tiles;
+}
@@ -9,6 +9,7 @@ namespace engine::io
 {
     std::string read(const std::string& path);
     std::vector<std::string> read_all_lines(const std::string& path);
+    std::vector<std::vector<int>> read_tile_map(const std::string& path);
 }
 
 #endif
@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "job_system.h"
+#include "logger.h"
+
+// Starts the worker threads. A negative worker count uses one worker per hardware thread, minus the calling thread.
+engine::job_system::job_system(int worker_count)
+{
+    _unfinished_jobs = 0;
+    _is_stopping = false;
+
+    if (worker_count < 0)
+    {
+        worker_count = std::max(0, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    }
+
+    for (int i = 0; i < worker_count; i++)
+    {
+        _workers.emplace_back(&job_system::run_worker, this);
+    }
+
+    logger::log("Job system started with " + std::to_string(worker_count) + " workers.");
+}
+
+// Finishes every queued job, then stops the workers.
+engine::job_system::~job_system()
+{
+    wait();
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _is_stopping = true;
+    }
+    _job_available.notify_all();
+
+    for (std::thread& worker: _workers)
+    {
+        worker.join();
+    }
+}
+
+int engine::job_system::get_worker_count() const
+{
+    return static_cast<int>(_workers.size());
+}
+
+void engine::job_system::run_worker()
+{
+    while (true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _job_available.wait(lock, [this] { return _is_stopping || !_jobs.empty(); });
+            if (_jobs.empty())
+            {
+                return;
+            }
+
+            job = std::move(_jobs.front());
+            _jobs.pop_front();
+        }
+
+        job();
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _unfinished_jobs--;
+        }
+        _jobs_finished.notify_all();
+    }
+}
+
+// Queues a job. Without any workers, the job runs right away on the calling thread.
+void engine::job_system::submit(std::function<void()> job)
+{
+    if (_workers.empty())
+    {
+        job();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _jobs.push_back(std::move(job));
+        _unfinished_jobs++;
+    }
+    _job_available.notify_one();
+}
+
+// Blocks until every submitted job has finished.
+void engine::job_system::wait()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _jobs_finished.wait(lock, [this] { return _unfinished_jobs == 0; });
+}
+
+/**
+ * Calls function(begin, end) for consecutive chunks of [0, count) in parallel and returns once all of them are done.
+ * Chunks are handed out dynamically, so uneven chunks balance out across threads.
+ *
+ * Helpers share the queue with other jobs, such as path searches, and may only start after those. The calling
+ * thread works through chunks itself and waits for chunks, never for helpers, so it doesn't stall behind a busy
+ * queue. Helpers that start late find no chunks left and return; they own a copy of the function for that reason.
+ */
+void engine::job_system::parallel_for(int count, int chunk_size, const std::function<void(int begin, int end)>& function)
+{
+    if (count <= 0)
+    {
+        return;
+    }
+
+    chunk_size = std::max(1, chunk_size);
+    const int chunk_count = (count + chunk_size - 1) / chunk_size;
+    const int helper_count = std::min(get_worker_count(), chunk_count - 1);
+    if (helper_count <= 0)
+    {
+        function(0, count);
+        return;
+    }
+
+    struct shared_state
+    {
+        std::function<void(int begin, int end)> function;
+        std::atomic<int> next_chunk { 0 };
+        int finished_chunks = 0;
+        std::mutex mutex;
+        std::condition_variable chunks_finished;
+    };
+    std::shared_ptr<shared_state> state = std::make_shared<shared_state>();
+    state->function = function;
+
+    auto run_chunks = [count, chunk_size, chunk_count](shared_state& shared)
+    {
+        int finished = 0;
+        for (int chunk = shared.next_chunk++; chunk < chunk_count; chunk = shared.next_chunk++)
+        {
+            const int begin = chunk * chunk_size;
+            shared.function(begin, std::min(count, begin + chunk_size));
+            finished++;
+        }
+
+        if (finished > 0)
+        {
+            std::lock_guard<std::mutex> lock(shared.mutex);
+            shared.finished_chunks += finished;
+            if (shared.finished_chunks == chunk_count)
+            {
+                shared.chunks_finished.notify_all();
+            }
+        }
+    };
+
+    for (int i = 0; i < helper_count; i++)
+    {
+        submit([state, run_chunks]()
+        {
+            run_chunks(*state);
+        });
+    }
+
+    run_chunks(*state);
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->chunks_finished.wait(lock, [&state, chunk_count] { return state->finished_chunks == chunk_count; });
+}
@@ -0,0 +1,48 @@
+#ifndef ENGINE_JOBSYSTEM_H
+#define ENGINE_JOBSYSTEM_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace engine
+{
+    /**
+     * Fixed pool of worker threads that run jobs from a shared queue.
+     *
+     * Jobs are fire and forget; anything they produce has to be handed back by the job itself (e.g. into a
+     * mutex protected list the main thread drains). parallel_for splits a range into chunks and blocks until
+     * every chunk is done, with the calling thread working on chunks too.
+     */
+    class job_system
+    {
+        private:
+            std::vector<std::thread> _workers;
+            std::deque<std::function<void()>> _jobs;
+            std::mutex _mutex;
+            std::condition_variable _job_available;
+            std::condition_variable _jobs_finished;
+            int _unfinished_jobs;
+            bool _is_stopping;
+
+            void run_worker();
+
+        public:
+            job_system(int worker_count = -1);
+            ~job_system();
+
+            job_system(const job_system&) = delete;
+            job_system& operator =(const job_system&) = delete;
+
+            int get_worker_count() const;
+
+            void submit(std::function<void()> job);
+            void wait();
+            void parallel_for(int count, int chunk_size, const std::function<void(int begin, int end)>& function);
+    };
+}
+
+#endif
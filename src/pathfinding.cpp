@@ -0,0 +1,384 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "hierarchical_graph.h"
+#include "logger.h"
+#include "pathfinding.h"
+
+engine::navigation::search_context::search_context()
+{
+    _node_count = 0;
+    _generation = 0;
+    _heap_size = 0;
+}
+
+// Allocates room for a grid with node_count tiles. Only reallocates when the size changes.
+void engine::navigation::search_context::resize(int node_count)
+{
+    if (node_count == _node_count)
+    {
+        return;
+    }
+
+    _node_count = node_count;
+    _generation = 0;
+    _stamps.assign(node_count, 0);
+    _costs.resize(node_count);
+    _priorities.resize(node_count);
+    _parents.resize(node_count);
+    _heap_positions.resize(node_count);
+    _heap.resize(node_count);
+}
+
+// Invalidates every node from the previous search in O(1).
+void engine::navigation::search_context::begin_search()
+{
+    _generation++;
+    if (_generation == 0)
+    {
+        // The generation wrapped around, so old stamps could match again. Clear them once.
+        std::fill(_stamps.begin(), _stamps.end(), 0);
+        _generation = 1;
+    }
+
+    _heap_size = 0;
+}
+
+bool engine::navigation::search_context::is_visited(int node) const
+{
+    return _stamps[node] == _generation;
+}
+
+// Closed nodes have been popped from the open list and have their final cost.
+bool engine::navigation::search_context::is_closed(int node) const
+{
+    return is_visited(node) && _heap_positions[node] < 0;
+}
+
+float engine::navigation::search_context::get_cost(int node) const
+{
+    return _costs[node];
+}
+
+int engine::navigation::search_context::get_parent(int node) const
+{
+    return _parents[node];
+}
+
+void engine::navigation::search_context::close(int node)
+{
+    _heap_positions[node] = -1;
+}
+
+bool engine::navigation::search_context::is_open_empty() const
+{
+    return _heap_size == 0;
+}
+
+// Adds a node to the open list, or lowers its priority if it's already open with a higher cost.
+void engine::navigation::search_context::push_or_decrease(int node, float cost, float priority, int parent)
+{
+    if (!is_visited(node))
+    {
+        _stamps[node] = _generation;
+        _costs[node] = cost;
+        _priorities[node] = priority;
+        _parents[node] = parent;
+        _heap[_heap_size] = node;
+        _heap_positions[node] = _heap_size;
+        sift_up(_heap_size++);
+        return;
+    }
+
+    if (_heap_positions[node] < 0 || cost >= _costs[node])
+    {
+        return;
+    }
+
+    _costs[node] = cost;
+    _priorities[node] = priority;
+    _parents[node] = parent;
+    sift_up(_heap_positions[node]);
+}
+
+// Removes and returns the open node with the lowest priority.
+int engine::navigation::search_context::pop()
+{
+    const int node = _heap[0];
+    _heap_size--;
+    if (_heap_size > 0)
+    {
+        _heap[0] = _heap[_heap_size];
+        _heap_positions[_heap[0]] = 0;
+        sift_down(0);
+    }
+
+    close(node);
+    return node;
+}
+
+void engine::navigation::search_context::sift_up(int position)
+{
+    const int node = _heap[position];
+    while (position > 0)
+    {
+        const int parent = (position - 1) / 2;
+        if (_priorities[_heap[parent]] <= _priorities[node])
+        {
+            break;
+        }
+
+        _heap[position] = _heap[parent];
+        _heap_positions[_heap[position]] = position;
+        position = parent;
+    }
+
+    _heap[position] = node;
+    _heap_positions[node] = position;
+}
+
+void engine::navigation::search_context::sift_down(int position)
+{
+    const int node = _heap[position];
+    while (true)
+    {
+        int child = position * 2 + 1;
+        if (child >= _heap_size)
+        {
+            break;
+        }
+
+        if (child + 1 < _heap_size && _priorities[_heap[child + 1]] < _priorities[_heap[child]])
+        {
+            child++;
+        }
+
+        if (_priorities[node] <= _priorities[_heap[child]])
+        {
+            break;
+        }
+
+        _heap[position] = _heap[child];
+        _heap_positions[_heap[position]] = position;
+        position = child;
+    }
+
+    _heap[position] = node;
+    _heap_positions[node] = position;
+}
+
+/**
+ * A* over the grid's non solid tiles with 8 way movement. Diagonal moves can't cut the corner of a solid tile.
+ * Uses the octile distance, which never overestimates on this kind of grid, as the heuristic.
+ */
+bool engine::navigation::search_context::find_path(const physics::solidity_grid& grid, glm::ivec2 start, glm::ivec2 goal, tile_path& path)
+{
+    path.clear();
+    if (grid.is_solid(start.x, start.y) || grid.is_solid(goal.x, goal.y))
+    {
+        return false;
+    }
+
+    const int width = grid.get_width();
+    resize(width * grid.get_height());
+    begin_search();
+
+    const float diagonal_cost = 1.41421356f;
+    auto heuristic = [&goal, diagonal_cost](int x, int y)
+    {
+        const int dx = std::abs(x - goal.x);
+        const int dy = std::abs(y - goal.y);
+        return (dx + dy) + (diagonal_cost - 2.0f) * std::min(dx, dy);
+    };
+
+    const int start_node = start.y * width + start.x;
+    const int goal_node = goal.y * width + goal.x;
+    push_or_decrease(start_node, 0.0f, heuristic(start.x, start.y), -1);
+
+    const int offsets_x[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+    const int offsets_y[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+    while (!is_open_empty())
+    {
+        const int node = pop();
+        if (node == goal_node)
+        {
+            for (int current = goal_node; current >= 0; current = get_parent(current))
+            {
+                path.push_back(glm::ivec2(current % width, current / width));
+            }
+            std::reverse(path.begin(), path.end());
+            return true;
+        }
+
+        const int x = node % width;
+        const int y = node / width;
+        for (int i = 0; i < 8; i++)
+        {
+            const int next_x = x + offsets_x[i];
+            const int next_y = y + offsets_y[i];
+            if (grid.is_solid(next_x, next_y))
+            {
+                continue;
+            }
+
+            const bool is_diagonal = i >= 4;
+            if (is_diagonal && (grid.is_solid(next_x, y) || grid.is_solid(x, next_y)))
+            {
+                continue;
+            }
+
+            const int next_node = next_y * width + next_x;
+            if (is_closed(next_node))
+            {
+                continue;
+            }
+
+            const float cost = get_cost(node) + (is_diagonal ? diagonal_cost : 1.0f);
+            push_or_decrease(next_node, cost, cost + heuristic(next_x, next_y), node);
+        }
+    }
+
+    return false;
+}
+
+engine::navigation::pathfinder::pathfinder(const physics::solidity_grid* grid, job_system* jobs)
+{
+    _grid = grid;
+    _jobs = jobs;
+    _hierarchy = nullptr;
+    _next_request_id = 0;
+    _cache_grid_version = grid->get_version();
+}
+
+uint64_t engine::navigation::pathfinder::get_cache_key(glm::ivec2 start, glm::ivec2 goal) const
+{
+    const uint32_t start_index = static_cast<uint32_t>(start.y * _grid->get_width() + start.x);
+    const uint32_t goal_index = static_cast<uint32_t>(goal.y * _grid->get_width() + goal.x);
+    return (static_cast<uint64_t>(start_index) << 32) | goal_index;
+}
+
+std::shared_ptr<const engine::navigation::tile_path> engine::navigation::pathfinder::find_cached(glm::ivec2 start, glm::ivec2 goal)
+{
+    std::lock_guard<std::mutex> lock(_cache_mutex);
+
+    // Any change to the grid could invalidate any path.
+    if (_cache_grid_version != _grid->get_version())
+    {
+        _cache.clear();
+        _cache_grid_version = _grid->get_version();
+    }
+
+    auto cached = _cache.find(get_cache_key(start, goal));
+    return cached != _cache.end() ? cached->second : nullptr;
+}
+
+void engine::navigation::pathfinder::store_cached(glm::ivec2 start, glm::ivec2 goal, std::shared_ptr<const tile_path> path)
+{
+    std::lock_guard<std::mutex> lock(_cache_mutex);
+    if (static_cast<int>(_cache.size()) >= MAX_CACHED_PATHS)
+    {
+        _cache.clear();
+    }
+
+    _cache[get_cache_key(start, goal)] = path;
+}
+
+void engine::navigation::pathfinder::clear_cache()
+{
+    std::lock_guard<std::mutex> lock(_cache_mutex);
+    _cache.clear();
+}
+
+std::unique_ptr<engine::navigation::search_context> engine::navigation::pathfinder::acquire_context()
+{
+    std::lock_guard<std::mutex> lock(_contexts_mutex);
+    if (_free_contexts.empty())
+    {
+        return std::make_unique<search_context>();
+    }
+
+    std::unique_ptr<search_context> context = std::move(_free_contexts.back());
+    _free_contexts.pop_back();
+    return context;
+}
+
+void engine::navigation::pathfinder::release_context(std::unique_ptr<search_context> context)
+{
+    std::lock_guard<std::mutex> lock(_contexts_mutex);
+    _free_contexts.push_back(std::move(context));
+}
+
+void engine::navigation::pathfinder::complete(path_result result, path_callback callback)
+{
+    std::lock_guard<std::mutex> lock(_completed_mutex);
+    _completed.push_back(std::make_pair(std::move(result), std::move(callback)));
+}
+
+// Sets the graph used for long distance requests. Pass nullptr to search the grid directly.
+void engine::navigation::pathfinder::set_hierarchical_graph(hierarchical_graph* hierarchy)
+{
+    _hierarchy = hierarchy;
+}
+
+/**
+ * Queues a path search between two tiles and returns the request ID.
+ * The callback runs on the main thread, from dispatch_completed(), once the search is done.
+ */
+int engine::navigation::pathfinder::request_path(glm::ivec2 start, glm::ivec2 goal, path_callback callback)
+{
+    const int request_id = _next_request_id++;
+
+    std::shared_ptr<const tile_path> cached = find_cached(start, goal);
+    if (cached)
+    {
+        complete({ request_id, start, goal, !cached->empty(), cached }, std::move(callback));
+        return request_id;
+    }
+
+    // After tile edits, bring the graph up to date before planning over it again. Searches already in flight may
+    // still be reading it, so they have to finish first. Edits are rare, so the wait is too.
+    if (_hierarchy && _hierarchy->is_out_of_date())
+    {
+        _jobs->wait();
+        _hierarchy->update();
+    }
+
+    _jobs->submit([this, request_id, start, goal, callback]()
+    {
+        std::unique_ptr<search_context> context = acquire_context();
+        std::shared_ptr<tile_path> path = std::make_shared<tile_path>();
+        const int distance = std::max(std::abs(goal.x - start.x), std::abs(goal.y - start.y));
+        const bool is_long = _hierarchy && distance >= hierarchical_distance;
+        const bool found = is_long ? _hierarchy->find_path(*context, start, goal, *path) : context->find_path(*_grid, start, goal, *path);
+        release_context(std::move(context));
+
+        // Failed searches are cached too (as empty paths), so unreachable goals aren't searched over and over.
+        store_cached(start, goal, path);
+        complete({ request_id, start, goal, found, path }, callback);
+    });
+
+    return request_id;
+}
+
+// Hands every finished request to its callback. Call from the main thread.
+void engine::navigation::pathfinder::dispatch_completed()
+{
+    {
+        std::lock_guard<std::mutex> lock(_completed_mutex);
+        _dispatching.swap(_completed);
+    }
+
+    for (std::pair<path_result, path_callback>& completed: _dispatching)
+    {
+        if (completed.second)
+        {
+            completed.second(completed.first);
+        }
+    }
+
+    _dispatching.clear();
+}
@@ -0,0 +1,138 @@
+#ifndef ENGINE_PATHFINDING_H
+#define ENGINE_PATHFINDING_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <glm/vec2.hpp>
+#include "job_system.h"
+#include "solidity_grid.h"
+
+namespace engine::navigation
+{
+    class hierarchical_graph;
+
+    typedef std::vector<glm::ivec2> tile_path;
+
+    /**
+     * Result of a path request. The path runs from the start tile to the goal tile, both included.
+     */
+    struct path_result
+    {
+        int request_id;
+        glm::ivec2 start;
+        glm::ivec2 goal;
+        bool found;
+        std::shared_ptr<const tile_path> path;
+    };
+
+    typedef std::function<void(const path_result& result)> path_callback;
+
+    /**
+     * Scratch memory for one A* search over a grid, allocated once and reused.
+     *
+     * Instead of clearing every node before a search, each search bumps the generation and a node only counts
+     * as visited this search if its stamp matches. The open list is a binary heap of node indices with each
+     * node's heap position tracked, so a node's priority can be lowered in place.
+     */
+    class search_context
+    {
+        private:
+            int _node_count;
+            uint32_t _generation;
+
+            std::vector<uint32_t> _stamps;
+            std::vector<float> _costs;
+            std::vector<float> _priorities;
+            std::vector<int> _parents;
+            std::vector<int> _heap_positions;
+            std::vector<int> _heap;
+            int _heap_size;
+
+            void sift_up(int position);
+            void sift_down(int position);
+
+        public:
+            search_context();
+            ~search_context() = default;
+
+            void resize(int node_count);
+            void begin_search();
+
+            bool is_visited(int node) const;
+            bool is_closed(int node) const;
+            float get_cost(int node) const;
+            int get_parent(int node) const;
+            void close(int node);
+
+            bool is_open_empty() const;
+            void push_or_decrease(int node, float cost, float priority, int parent);
+            int pop();
+
+            bool find_path(const physics::solidity_grid& grid, glm::ivec2 start, glm::ivec2 goal, tile_path& path);
+    };
+
+    /**
+     * Pathfinding service over a tilemap's solidity grid.
+     *
+     * Requests run asynchronously on the job system, each using a search context borrowed from a pool.
+     * Finished paths are cached by (start tile, goal tile) until the grid changes, and results are handed to
+     * their callbacks on the main thread by dispatch_completed(), which the game calls once per tick, so
+     * results arrive on the tick after they were computed.
+     *
+     * With a hierarchical graph set, requests between tiles at least hierarchical_distance tiles apart are planned
+     * over the graph instead of searching the whole grid.
+     *
+     * The grid (and the hierarchical graph) must not change while requests are in flight.
+     */
+    class pathfinder
+    {
+        private:
+            const physics::solidity_grid* _grid;
+            job_system* _jobs;
+            hierarchical_graph* _hierarchy;
+            int _next_request_id;
+
+            std::mutex _contexts_mutex;
+            std::vector<std::unique_ptr<search_context>> _free_contexts;
+
+            std::mutex _cache_mutex;
+            std::unordered_map<uint64_t, std::shared_ptr<const tile_path>> _cache;
+            unsigned int _cache_grid_version;
+
+            std::mutex _completed_mutex;
+            std::vector<std::pair<path_result, path_callback>> _completed;
+            std::vector<std::pair<path_result, path_callback>> _dispatching;
+
+            uint64_t get_cache_key(glm::ivec2 start, glm::ivec2 goal) const;
+            std::shared_ptr<const tile_path> find_cached(glm::ivec2 start, glm::ivec2 goal);
+            void store_cached(glm::ivec2 start, glm::ivec2 goal, std::shared_ptr<const tile_path> path);
+
+            std::unique_ptr<search_context> acquire_context();
+            void release_context(std::unique_ptr<search_context> context);
+
+            void complete(path_result result, path_callback callback);
+
+        public:
+            // Cached paths beyond this count flush the cache.
+            static const int MAX_CACHED_PATHS = 4096;
+
+            // Requests at least this many tiles apart (in either axis) are planned over the hierarchical graph, if set.
+            // Nearer goals are cheaper and shorter to search directly.
+            int hierarchical_distance = 16;
+
+            pathfinder(const physics::solidity_grid* grid, job_system* jobs);
+            ~pathfinder() = default;
+
+            void set_hierarchical_graph(hierarchical_graph* hierarchy);
+
+            int request_path(glm::ivec2 start, glm::ivec2 goal, path_callback callback);
+            void dispatch_completed();
+            void clear_cache();
+    };
+}
+
+#endif
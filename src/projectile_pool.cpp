@@ -0,0 +1,181 @@
+#include <algorithm>
+#include <vector>
+#include <SDL2/SDL.h>
+#include "projectile_pool.h"
+#include "render_frame.h"
+
+engine::projectile_pool::projectile_pool(int capacity)
+{
+    _capacity = std::max(capacity, 1);
+    _tail = 0;
+    _count = 0;
+
+    _x.resize(_capacity);
+    _y.resize(_capacity);
+    _velocity_x.resize(_capacity);
+    _velocity_y.resize(_capacity);
+    _lifetime.assign(_capacity, 0.0f);
+    _owner.assign(_capacity, -1);
+}
+
+int engine::projectile_pool::get_capacity() const
+{
+    return _capacity;
+}
+
+// Number of slots between the tail and the head. May include projectiles that were killed early.
+int engine::projectile_pool::get_count() const
+{
+    return _count;
+}
+
+// Adds a projectile and returns its slot index, which stays valid until the projectile expires.
+int engine::projectile_pool::spawn(glm::vec2 position, glm::vec2 velocity, float lifetime, int owner)
+{
+    if (_count == _capacity)
+    {
+        _tail = (_tail + 1) % _capacity;
+        _count--;
+    }
+
+    const int index = (_tail + _count) % _capacity;
+    _count++;
+
+    _x[index] = position.x;
+    _y[index] = position.y;
+    _velocity_x[index] = velocity.x;
+    _velocity_y[index] = velocity.y;
+    _lifetime[index] = lifetime;
+    _owner[index] = owner;
+    return index;
+}
+
+// Expires a projectile early, e.g. when it hits something.
+void engine::projectile_pool::kill(int index)
+{
+    _lifetime[index] = 0.0f;
+}
+
+void engine::projectile_pool::clear()
+{
+    _tail = 0;
+    _count = 0;
+}
+
+bool engine::projectile_pool::is_alive(int index) const
+{
+    return _lifetime[index] > 0.0f;
+}
+
+glm::vec2 engine::projectile_pool::get_position(int index) const
+{
+    return glm::vec2(_x[index], _y[index]);
+}
+
+int engine::projectile_pool::get_owner(int index) const
+{
+    return _owner[index];
+}
+
+// Kept free of branches and with unaliased arrays so the compiler vectorizes it.
+static void run_projectile_kernel(
+    int count, float delta_time,
+    float* __restrict x, float* __restrict y,
+    const float* __restrict velocity_x, const float* __restrict velocity_y,
+    float* __restrict lifetime)
+{
+    for (int i = 0; i < count; i++)
+    {
+        x[i] += velocity_x[i] * delta_time;
+        y[i] += velocity_y[i] * delta_time;
+        lifetime[i] -= delta_time;
+    }
+}
+
+void engine::projectile_pool::update_range(int begin, int end, float delta_time)
+{
+    run_projectile_kernel(
+        end - begin, delta_time,
+        _x.data() + begin, _y.data() + begin,
+        _velocity_x.data() + begin, _velocity_y.data() + begin,
+        _lifetime.data() + begin
+    );
+}
+
+/**
+ * Moves every projectile and counts down its lifetime. Dead projectiles are moved too; that's cheaper than
+ * skipping them. Afterwards, expired projectiles are dropped from the tail.
+ */
+void engine::projectile_pool::update(float delta_time)
+{
+    // The live slots wrap around the end of the arrays at most once, so they're at most two contiguous runs.
+    const int first_end = std::min(_tail + _count, _capacity);
+    update_range(_tail, first_end, delta_time);
+    update_range(0, _tail + _count - first_end, delta_time);
+
+    while (_count > 0 && _lifetime[_tail] <= 0.0f)
+    {
+        _tail = (_tail + 1) % _capacity;
+        _count--;
+    }
+}
+
+/**
+ * Adds every live projectile to a frame as a square of the given size, all in one batch so they take one draw
+ * call. Positions are extrapolated back by (1 - alpha) ticks so projectiles line up with the interpolated
+ * entities. Projectiles outside the view are skipped; the rest are mapped to the screen relative to the view and
+ * scaled by the zoom. Returns the number added.
+ */
+int engine::projectile_pool::build(render_frame& frame, int layer, const resources::texture_region& image, int size, float alpha, float tick_delta_time, const physics::aabb& view, float zoom)
+{
+    sprite_batch batch = { layer, image.texture, static_cast<int>(frame.vertices.size()), 0, static_cast<int>(frame.indices.size()), 0 };
+
+    const float back = (alpha - 1.0f) * tick_delta_time;
+    const SDL_Color color = { 255, 255, 255, 255 };
+    const float u0 = static_cast<float>(image.rect.x) / image.texture_width;
+    const float v0 = static_cast<float>(image.rect.y) / image.texture_height;
+    const float u1 = static_cast<float>(image.rect.x + image.rect.w) / image.texture_width;
+    const float v1 = static_cast<float>(image.rect.y + image.rect.h) / image.texture_height;
+    for (int i = 0; i < _count; i++)
+    {
+        const int index = (_tail + i) % _capacity;
+        if (_lifetime[index] <= 0.0f)
+        {
+            continue;
+        }
+
+        const glm::vec2 position(_x[index] + _velocity_x[index] * back, _y[index] + _velocity_y[index] * back);
+        if (!view.overlaps(physics::aabb(position, position + glm::vec2(size, size))))
+        {
+            continue;
+        }
+
+        const float x = (position.x - view.min.x) * zoom;
+        const float y = (position.y - view.min.y) * zoom;
+        const float screen_size = size * zoom;
+        const int first = batch.vertex_count;
+        frame.vertices.push_back({ { x, y }, color, { u0, v0 } });
+        frame.vertices.push_back({ { x + screen_size, y }, color, { u1, v0 } });
+        frame.vertices.push_back({ { x + screen_size, y + screen_size }, color, { u1, v1 } });
+        frame.vertices.push_back({ { x, y + screen_size }, color, { u0, v1 } });
+
+        const int indices[6] = { first, first + 1, first + 2, first, first + 2, first + 3 };
+        frame.indices.insert(frame.indices.end(), indices, indices + 6);
+        batch.vertex_count += 4;
+        batch.index_count += 6;
+    }
+
+    const int count = batch.vertex_count / 4;
+    if (count > 0 && image.texture)
+    {
+        frame.batches.push_back(batch);
+        frame.sprite_count += count;
+    }
+    else
+    {
+        frame.vertices.resize(batch.first_vertex);
+        frame.indices.resize(batch.first_index);
+    }
+
+    return count;
+}
@@ -0,0 +1,56 @@
+#ifndef ENGINE_PROJECTILEPOOL_H
+#define ENGINE_PROJECTILEPOOL_H
+
+#include <vector>
+#include <glm/vec2.hpp>
+#include "aabb.h"
+#include "render_frame.h"
+#include "resources.h"
+
+namespace engine
+{
+    /**
+     * Fixed capacity pool of short lived projectiles, kept out of the ECS so bullets don't churn the registry.
+     *
+     * Projectiles live in a ring buffer stored as one array per field. New projectiles go in at the head and the
+     * oldest sit at the tail, so with similar lifetimes they also expire from the tail, one index bump each.
+     * Projectiles killed early are only flagged with a lifetime of zero and are skipped until the tail reaches them.
+     * When the pool is full, spawning replaces the oldest projectile.
+     */
+    class projectile_pool
+    {
+        private:
+            int _capacity;
+            int _tail;
+            int _count;
+
+            std::vector<float> _x;
+            std::vector<float> _y;
+            std::vector<float> _velocity_x;
+            std::vector<float> _velocity_y;
+            std::vector<float> _lifetime;
+            std::vector<int> _owner;
+
+            void update_range(int begin, int end, float delta_time);
+
+        public:
+            projectile_pool(int capacity = 4096);
+            ~projectile_pool() = default;
+
+            int get_capacity() const;
+            int get_count() const;
+
+            int spawn(glm::vec2 position, glm::vec2 velocity, float lifetime, int owner = -1);
+            void kill(int index);
+            void clear();
+
+            bool is_alive(int index) const;
+            glm::vec2 get_position(int index) const;
+            int get_owner(int index) const;
+
+            void update(float delta_time);
+            int build(render_frame& frame, int layer, const resources::texture_region& image, int size, float alpha, float tick_delta_time, const physics::aabb& view, float zoom);
+    };
+}
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef ENGINE_RENDERFRAME_H
+#define ENGINE_RENDERFRAME_H
+
+#include <vector>
+#include <SDL2/SDL.h>
+
+namespace engine
+{
+    /**
+     * Run of quads on the same layer sharing a texture, drawn with a single draw call.
+     * Indices are relative to the batch's first vertex.
+     */
+    struct sprite_batch
+    {
+        int layer;
+        SDL_Texture* texture;
+        int first_vertex;
+        int vertex_count;
+        int first_index;
+        int index_count;
+    };
+
+    /**
+     * Everything needed to draw one frame's sprites, built from the world but independent of it.
+     */
+    struct render_frame
+    {
+        std::vector<SDL_Vertex> vertices;
+        std::vector<int> indices;
+        std::vector<sprite_batch> batches;
+        int sprite_count = 0;
+
+        void clear()
+        {
+            vertices.clear();
+            indices.clear();
+            batches.clear();
+            sprite_count = 0;
+        }
+    };
+}
+
+#endif
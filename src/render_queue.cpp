@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "render_queue.h"
+
+/**
+ * Packs a sort key. Layers are signed and biased so negative layers sort first; depth is rounded to whole units
+ * and clamped, with lower depths drawn first. Fields that don't fit their bits are clamped or wrapped.
+ */
+uint64_t engine::render_queue::make_key(int layer, int texture, float depth, uint32_t sequence)
+{
+    const uint64_t layer_bits = static_cast<uint64_t>(std::clamp(layer + (1 << (LAYER_BITS - 1)), 0, (1 << LAYER_BITS) - 1));
+    const uint64_t texture_bits = static_cast<uint64_t>(texture) & ((1u << TEXTURE_BITS) - 1);
+    const int depth_value = static_cast<int>(std::lround(std::clamp(depth, -524288.0f, 524287.0f))) + (1 << (DEPTH_BITS - 1));
+    const uint64_t depth_bits = static_cast<uint64_t>(std::clamp(depth_value, 0, (1 << DEPTH_BITS) - 1));
+    const uint64_t sequence_bits = sequence & ((1u << SEQUENCE_BITS) - 1);
+
+    return (layer_bits << (TEXTURE_BITS + DEPTH_BITS + SEQUENCE_BITS))
+        | (texture_bits << (DEPTH_BITS + SEQUENCE_BITS))
+        | (depth_bits << SEQUENCE_BITS)
+        | sequence_bits;
+}
+
+int engine::render_queue::get_layer(uint64_t key)
+{
+    return static_cast<int>(key >> (TEXTURE_BITS + DEPTH_BITS + SEQUENCE_BITS)) - (1 << (LAYER_BITS - 1));
+}
+
+int engine::render_queue::get_texture(uint64_t key)
+{
+    return static_cast<int>((key >> (DEPTH_BITS + SEQUENCE_BITS)) & ((1u << TEXTURE_BITS) - 1));
+}
+
+void engine::render_queue::clear()
+{
+    _keys.clear();
+    _items.clear();
+}
+
+void engine::render_queue::push(uint64_t key, int item)
+{
+    _keys.push_back(key);
+    _items.push_back(item);
+}
+
+/**
+ * Sorts by key, one byte per pass from least to most significant. All eight histograms are counted in a single
+ * pass up front, and a pass is skipped when every key has the same byte there, which is common for the upper
+ * bytes of a frame with few layers and textures.
+ */
+void engine::render_queue::sort()
+{
+    const size_t count = _keys.size();
+    if (count < 2)
+    {
+        return;
+    }
+
+    std::vector<uint32_t> counts(8 * 256, 0);
+    for (const uint64_t key: _keys)
+    {
+        for (int pass = 0; pass < 8; pass++)
+        {
+            counts[pass * 256 + ((key >> (pass * 8)) & 0xFF)]++;
+        }
+    }
+
+    _scratch_keys.resize(count);
+    _scratch_items.resize(count);
+    for (int pass = 0; pass < 8; pass++)
+    {
+        uint32_t* pass_counts = counts.data() + pass * 256;
+        const int shift = pass * 8;
+        if (pass_counts[(_keys[0] >> shift) & 0xFF] == count)
+        {
+            continue;
+        }
+
+        // Turn the counts into starting offsets.
+        uint32_t offset = 0;
+        for (int i = 0; i < 256; i++)
+        {
+            const uint32_t bucket_count = pass_counts[i];
+            pass_counts[i] = offset;
+            offset += bucket_count;
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const uint32_t destination = pass_counts[(_keys[i] >> shift) & 0xFF]++;
+            _scratch_keys[destination] = _keys[i];
+            _scratch_items[destination] = _items[i];
+        }
+
+        _keys.swap(_scratch_keys);
+        _items.swap(_scratch_items);
+    }
+}
+
+int engine::render_queue::get_size() const
+{
+    return static_cast<int>(_keys.size());
+}
+
+uint64_t engine::render_queue::get_key(int index) const
+{
+    return _keys[index];
+}
+
+// Item pushed with the key at this position of the queue.
+int engine::render_queue::get_item(int index) const
+{
+    return _items[index];
+}
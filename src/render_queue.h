@@ -0,0 +1,48 @@
+#ifndef ENGINE_RENDERQUEUE_H
+#define ENGINE_RENDERQUEUE_H
+
+#include <cstdint>
+#include <vector>
+
+namespace engine
+{
+    /**
+     * Flat list of draw items, each with a packed 64 bit sort key, sorted with an LSD radix sort.
+     *
+     * From the most significant bits down, a key holds the layer, the texture handle, the depth and a sequence
+     * number. Sorting by the whole key puts items in draw order and, within a layer, next to every other item
+     * sharing their texture, whatever order they were pushed in. Depth therefore only orders items that share a
+     * layer and texture. The sequence number makes every key unique, so equal items keep their push order.
+     */
+    class render_queue
+    {
+        private:
+            std::vector<uint64_t> _keys;
+            std::vector<int> _items;
+            std::vector<uint64_t> _scratch_keys;
+            std::vector<int> _scratch_items;
+
+        public:
+            static const int LAYER_BITS = 8;
+            static const int TEXTURE_BITS = 12;
+            static const int DEPTH_BITS = 20;
+            static const int SEQUENCE_BITS = 24;
+
+            render_queue() = default;
+            ~render_queue() = default;
+
+            static uint64_t make_key(int layer, int texture, float depth, uint32_t sequence);
+            static int get_layer(uint64_t key);
+            static int get_texture(uint64_t key);
+
+            void clear();
+            void push(uint64_t key, int item);
+            void sort();
+
+            int get_size() const;
+            uint64_t get_key(int index) const;
+            int get_item(int index) const;
+    };
+}
+
+#endif
@@ -1,36 +1,211 @@
+#include <algorithm>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
+#define STB_RECT_PACK_IMPLEMENTATION
+#include <imgui/imstb_rectpack.h>
 #include "logger.h"
 #include "resources.h"
 
-std::map<std::string, SDL_Texture*> _textures;
+/**
+ * Texture that images are packed into as they're loaded. The packer keeps its skyline between loads,
+ * so each new image is fitted around the ones already on the page.
+ */
+struct atlas_page
+{
+    SDL_Texture* texture;
+    stbrp_context context;
+    std::vector<stbrp_node> nodes;
+};
+
+// Regions indexed by texture handle. Handles of images that aren't loaded map to an empty region.
+std::unordered_map<std::string, engine::resources::texture_handle> _handles;
+std::vector<engine::resources::texture_region> _regions;
+const engine::resources::texture_region _empty_region = { nullptr, -1, { 0, 0, 0, 0 }, 1, 1 };
 
-// Clears all of the loaded textures from memory.
+std::vector<std::unique_ptr<atlas_page>> _atlas_pages;
+std::vector<SDL_Texture*> _owned_textures;
+
+// Clears all of the loaded textures from memory. Handles stay valid and resolve to nothing until reloaded.
 void engine::resources::clear_textures()
 {
-    for (std::pair<std::string, SDL_Texture*> pair: _textures)
+    for (SDL_Texture* texture: _owned_textures)
+    {
+        SDL_DestroyTexture(texture);
+    }
+
+    _owned_textures.clear();
+    _atlas_pages.clear();
+    std::fill(_regions.begin(), _regions.end(), _empty_region);
+}
+
+static atlas_page* create_atlas_page(SDL_Renderer* renderer)
+{
+    std::unique_ptr<atlas_page> page = std::make_unique<atlas_page>();
+    page->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, engine::resources::ATLAS_PAGE_SIZE, engine::resources::ATLAS_PAGE_SIZE);
+    if (!page->texture)
+    {
+        return nullptr;
+    }
+
+    SDL_SetTextureBlendMode(page->texture, SDL_BLENDMODE_BLEND);
+    page->nodes.resize(engine::resources::ATLAS_PAGE_SIZE);
+    stbrp_init_target(&page->context, engine::resources::ATLAS_PAGE_SIZE, engine::resources::ATLAS_PAGE_SIZE, page->nodes.data(), static_cast<int>(page->nodes.size()));
+
+    _owned_textures.push_back(page->texture);
+    _atlas_pages.push_back(std::move(page));
+    engine::logger::log("Atlas page " + std::to_string(_atlas_pages.size()) + " created.");
+    return _atlas_pages.back().get();
+}
+
+/**
+ * Packs an RGBA32 surface into the first atlas page with room for it, opening a new page if none has.
+ * The image is copied with its edge pixels repeated ATLAS_PADDING times around it.
+ */
+static bool pack_into_atlas(SDL_Renderer* renderer, SDL_Surface* surface, engine::resources::texture_region& region)
+{
+    const int padding = engine::resources::ATLAS_PADDING;
+    const int padded_width = surface->w + padding * 2;
+    const int padded_height = surface->h + padding * 2;
+    if (padded_width > engine::resources::ATLAS_PAGE_SIZE || padded_height > engine::resources::ATLAS_PAGE_SIZE)
+    {
+        return false;
+    }
+
+    stbrp_rect rect = {};
+    rect.w = static_cast<stbrp_coord>(padded_width);
+    rect.h = static_cast<stbrp_coord>(padded_height);
+
+    atlas_page* page = nullptr;
+    for (const std::unique_ptr<atlas_page>& candidate: _atlas_pages)
+    {
+        if (stbrp_pack_rects(&candidate->context, &rect, 1) && rect.was_packed)
+        {
+            page = candidate.get();
+            break;
+        }
+    }
+
+    if (!page)
     {
-        SDL_DestroyTexture(pair.second);
+        page = create_atlas_page(renderer);
+        if (!page || !stbrp_pack_rects(&page->context, &rect, 1) || !rect.was_packed)
+        {
+            return false;
+        }
     }
 
-    _textures.clear();
+    std::vector<uint32_t> pixels(padded_width * padded_height);
+    for (int y = 0; y < padded_height; y++)
+    {
+        const int source_y = std::clamp(y - padding, 0, surface->h - 1);
+        const uint32_t* source_row = reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(surface->pixels) + source_y * surface->pitch);
+        for (int x = 0; x < padded_width; x++)
+        {
+            pixels[y * padded_width + x] = source_row[std::clamp(x - padding, 0, surface->w - 1)];
+        }
+    }
+
+    const SDL_Rect padded_rect = { rect.x, rect.y, padded_width, padded_height };
+    SDL_UpdateTexture(page->texture, &padded_rect, pixels.data(), padded_width * static_cast<int>(sizeof(uint32_t)));
+
+    region.texture = page->texture;
+    region.texture_index = static_cast<int>(std::find(_owned_textures.begin(), _owned_textures.end(), page->texture) - _owned_textures.begin());
+    region.rect = { rect.x + padding, rect.y + padding, surface->w, surface->h };
+    region.texture_width = engine::resources::ATLAS_PAGE_SIZE;
+    region.texture_height = engine::resources::ATLAS_PAGE_SIZE;
+    return true;
 }
 
-// Loads a texture into memory.
+/**
+ * Loads an image into memory. Images are packed into shared atlas pages so sprites using different images
+ * can still be drawn together. Images too large for a page get a texture of their own.
+ */
 void engine::resources::load_texture(SDL_Renderer* renderer, const std::string& asset_id, const std::string& path)
 {
-    SDL_Surface* surface = IMG_Load(path.c_str());
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+    SDL_Surface* loaded = IMG_Load(path.c_str());
+    if (!loaded)
+    {
+        logger::error("Failed to load texture[" + asset_id + "] from [" + path + "].");
+        return;
+    }
+
+    SDL_Surface* surface = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(loaded);
+    if (!surface)
+    {
+        logger::error("Failed to convert texture[" + asset_id + "] from [" + path + "].");
+        return;
+    }
+
+    texture_region region;
+    if (!pack_into_atlas(renderer, surface, region))
+    {
+        region.texture = SDL_CreateTextureFromSurface(renderer, surface);
+        region.texture_index = static_cast<int>(_owned_textures.size());
+        region.rect = { 0, 0, surface->w, surface->h };
+        region.texture_width = surface->w;
+        region.texture_height = surface->h;
+        _owned_textures.push_back(region.texture);
+    }
     SDL_FreeSurface(surface);
 
-    _textures.emplace(asset_id, texture);
+    _regions[get_texture_handle(asset_id)] = region;
 
     logger::log("Texture[" + asset_id + "] loaded in memory from [" + path + "].");
 }
 
-// Retrieves the pointer to a texture loaded in memory.
+// Retrieves the pointer to a texture loaded in memory. For images packed into an atlas, that's the whole page.
 SDL_Texture* engine::resources::get_texture(const std::string& asset_id)
 {
-    return _textures[asset_id];
+    return get_texture_region(asset_id).texture;
+}
+
+/**
+ * Returns the handle of an asset ID, assigning the next free one the first time an ID is seen.
+ * IDs can be resolved before their image is loaded. Empty IDs get INVALID_TEXTURE.
+ */
+engine::resources::texture_handle engine::resources::get_texture_handle(const std::string& asset_id)
+{
+    if (asset_id.empty())
+    {
+        return INVALID_TEXTURE;
+    }
+
+    auto handle = _handles.find(asset_id);
+    if (handle != _handles.end())
+    {
+        return handle->second;
+    }
+
+    const texture_handle new_handle = static_cast<texture_handle>(_regions.size());
+    _handles.emplace(asset_id, new_handle);
+    _regions.push_back(_empty_region);
+    return new_handle;
+}
+
+// Retrieves the texture and rectangle a loaded image occupies. The texture is null if the image isn't loaded.
+const engine::resources::texture_region& engine::resources::get_texture_region(texture_handle handle)
+{
+    if (handle < 0 || handle >= static_cast<texture_handle>(_regions.size()))
+    {
+        return _empty_region;
+    }
+
+    return _regions[handle];
+}
+
+const engine::resources::texture_region& engine::resources::get_texture_region(const std::string& asset_id)
+{
+    auto handle = _handles.find(asset_id);
+    return handle != _handles.end() ? _regions[handle->second] : _empty_region;
+}
+
+int engine::resources::get_atlas_page_count()
+{
+    return static_cast<int>(_atlas_pages.size());
 }
@@ -1,7 +1,6 @@
 #ifndef ENGINE_RESOURCES_H
 #define ENGINE_RESOURCES_H
 
-#include <map>
 #include <string>
 #include <SDL2/SDL.h>
 
@@ -33,9 +32,38 @@ namespace engine::resources
         }
     };
 
+    /**
+     * Small integer standing in for a texture asset ID, resolved once so drawing doesn't look up strings.
+     */
+    typedef int texture_handle;
+
+    const texture_handle INVALID_TEXTURE = -1;
+
+    /**
+     * Where a loaded image ended up: a rectangle within a texture, usually an atlas page shared with other images.
+     * Images on the same texture share its texture index.
+     */
+    struct texture_region
+    {
+        SDL_Texture* texture;
+        int texture_index;
+        SDL_Rect rect;
+        int texture_width;
+        int texture_height;
+    };
+
+    // Width and height of an atlas page. Larger images get a texture of their own.
+    const int ATLAS_PAGE_SIZE = 2048;
+    // Pixels of each image's edge repeated around it, so filtering never samples a neighbouring image.
+    const int ATLAS_PADDING = 1;
+
     void clear_textures();
     void load_texture(SDL_Renderer* renderer, const std::string& asset_id, const std::string& path);
     SDL_Texture* get_texture(const std::string& asset_id);
+    texture_handle get_texture_handle(const std::string& asset_id);
+    const texture_region& get_texture_region(texture_handle handle);
+    const texture_region& get_texture_region(const std::string& asset_id);
+    int get_atlas_page_count();
 }
 
 #endif
@@ -0,0 +1,142 @@
+#include <cmath>
+#include <vector>
+#include "sat.h"
+
+// Builds an oriented box from an unrotated one, rotated clockwise (like SDL_RenderCopyEx) around its center.
+engine::physics::obb engine::physics::obb::from_aabb(const aabb& box, double rotation_degrees)
+{
+    const double radians = rotation_degrees * 3.14159265358979323846 / 180.0;
+
+    obb result;
+    result.center = box.get_center();
+    result.half_extents = box.get_size() * 0.5f;
+    result.axis = glm::vec2(static_cast<float>(std::cos(radians)), static_cast<float>(std::sin(radians)));
+    return result;
+}
+
+// Smallest axis aligned box containing the oriented box.
+engine::physics::aabb engine::physics::obb::get_bounds() const
+{
+    const float c = std::fabs(axis.x);
+    const float s = std::fabs(axis.y);
+    const glm::vec2 extents(
+        c * half_extents.x + s * half_extents.y,
+        s * half_extents.x + c * half_extents.y
+    );
+    return aabb(center - extents, center + extents);
+}
+
+void engine::physics::sat_batch::clear()
+{
+    _center_a_x.clear(); _center_a_y.clear(); _half_a_x.clear(); _half_a_y.clear(); _axis_a_x.clear(); _axis_a_y.clear();
+    _center_b_x.clear(); _center_b_y.clear(); _half_b_x.clear(); _half_b_y.clear(); _axis_b_x.clear(); _axis_b_y.clear();
+    _normal_x.clear(); _normal_y.clear(); _penetration.clear();
+}
+
+// Queues a pair for the next run() and returns its index in the results.
+int engine::physics::sat_batch::add(const obb& a, const obb& b)
+{
+    _center_a_x.push_back(a.center.x); _center_a_y.push_back(a.center.y);
+    _half_a_x.push_back(a.half_extents.x); _half_a_y.push_back(a.half_extents.y);
+    _axis_a_x.push_back(a.axis.x); _axis_a_y.push_back(a.axis.y);
+
+    _center_b_x.push_back(b.center.x); _center_b_y.push_back(b.center.y);
+    _half_b_x.push_back(b.half_extents.x); _half_b_y.push_back(b.half_extents.y);
+    _axis_b_x.push_back(b.axis.x); _axis_b_y.push_back(b.axis.y);
+
+    return static_cast<int>(_center_a_x.size()) - 1;
+}
+
+/**
+ * Projects both boxes onto one axis and keeps it if it has the least overlap so far.
+ * Selects instead of branches so the loop calling this stays vectorizable.
+ */
+static inline void test_axis(
+    float nx, float ny, float dx, float dy,
+    float half_a_x, float half_a_y, float axis_a_x, float axis_a_y,
+    float half_b_x, float half_b_y, float axis_b_x, float axis_b_y,
+    float& best, float& best_x, float& best_y)
+{
+    // Projected half widths of each box onto the axis.
+    const float radius_a = half_a_x * std::fabs(axis_a_x * nx + axis_a_y * ny) + half_a_y * std::fabs(-axis_a_y * nx + axis_a_x * ny);
+    const float radius_b = half_b_x * std::fabs(axis_b_x * nx + axis_b_y * ny) + half_b_y * std::fabs(-axis_b_y * nx + axis_b_x * ny);
+    const float distance = dx * nx + dy * ny;
+    const float overlap = radius_a + radius_b - std::fabs(distance);
+
+    // Flip the axis so the normal always points from the first box to the second.
+    const float sign = distance < 0.0f ? -1.0f : 1.0f;
+    const bool is_better = overlap < best;
+    best = is_better ? overlap : best;
+    best_x = is_better ? nx * sign : best_x;
+    best_y = is_better ? ny * sign : best_y;
+}
+
+/**
+ * Tests count pairs. Kept as a free function with restrict qualified arrays so the compiler knows the outputs
+ * don't alias the inputs and can vectorize the loop over pairs.
+ */
+static void run_sat_kernel(
+    int count,
+    const float* __restrict cax, const float* __restrict cay,
+    const float* __restrict hax, const float* __restrict hay,
+    const float* __restrict uax, const float* __restrict uay,
+    const float* __restrict cbx, const float* __restrict cby,
+    const float* __restrict hbx, const float* __restrict hby,
+    const float* __restrict ubx, const float* __restrict uby,
+    float* __restrict out_x, float* __restrict out_y, float* __restrict out_penetration)
+{
+    for (int i = 0; i < count; i++)
+    {
+        const float dx = cbx[i] - cax[i];
+        const float dy = cby[i] - cay[i];
+
+        float best = 3.402823466e+38f;
+        float best_x = 0.0f;
+        float best_y = 0.0f;
+
+        // The four candidate axes are both axes of each box. Kept unrolled so the loop over pairs vectorizes.
+        test_axis(uax[i], uay[i], dx, dy, hax[i], hay[i], uax[i], uay[i], hbx[i], hby[i], ubx[i], uby[i], best, best_x, best_y);
+        test_axis(-uay[i], uax[i], dx, dy, hax[i], hay[i], uax[i], uay[i], hbx[i], hby[i], ubx[i], uby[i], best, best_x, best_y);
+        test_axis(ubx[i], uby[i], dx, dy, hax[i], hay[i], uax[i], uay[i], hbx[i], hby[i], ubx[i], uby[i], best, best_x, best_y);
+        test_axis(-uby[i], ubx[i], dx, dy, hax[i], hay[i], uax[i], uay[i], hbx[i], hby[i], ubx[i], uby[i], best, best_x, best_y);
+
+        out_x[i] = best_x;
+        out_y[i] = best_y;
+        out_penetration[i] = best;
+    }
+}
+
+void engine::physics::sat_batch::run()
+{
+    const int count = get_size();
+    _normal_x.resize(count);
+    _normal_y.resize(count);
+    _penetration.resize(count);
+
+    run_sat_kernel(
+        count,
+        _center_a_x.data(), _center_a_y.data(), _half_a_x.data(), _half_a_y.data(), _axis_a_x.data(), _axis_a_y.data(),
+        _center_b_x.data(), _center_b_y.data(), _half_b_x.data(), _half_b_y.data(), _axis_b_x.data(), _axis_b_y.data(),
+        _normal_x.data(), _normal_y.data(), _penetration.data()
+    );
+}
+
+int engine::physics::sat_batch::get_size() const
+{
+    return static_cast<int>(_center_a_x.size());
+}
+
+bool engine::physics::sat_batch::is_colliding(int index) const
+{
+    return _penetration[index] > 0.0f;
+}
+
+glm::vec2 engine::physics::sat_batch::get_normal(int index) const
+{
+    return glm::vec2(_normal_x[index], _normal_y[index]);
+}
+
+float engine::physics::sat_batch::get_penetration(int index) const
+{
+    return _penetration[index];
+}
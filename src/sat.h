@@ -0,0 +1,53 @@
+#ifndef ENGINE_SAT_H
+#define ENGINE_SAT_H
+
+#include <vector>
+#include <glm/vec2.hpp>
+#include "aabb.h"
+
+namespace engine::physics
+{
+    /**
+     * Oriented box. Axis is the box's unit X axis; its Y axis is the perpendicular (-axis.y, axis.x).
+     */
+    struct obb
+    {
+        glm::vec2 center;
+        glm::vec2 half_extents;
+        glm::vec2 axis;
+
+        static obb from_aabb(const aabb& box, double rotation_degrees);
+        aabb get_bounds() const;
+    };
+
+    /**
+     * Batch of separating axis tests between pairs of oriented boxes.
+     *
+     * Pairs are stored as structure of arrays and run() tests all of them in one straight, branch free loop
+     * the compiler can vectorize. For each pair it produces the axis of least penetration, as a normal pointing
+     * from the first box to the second, and the penetration depth along it. Pairs that don't overlap get a
+     * penetration of zero or less.
+     */
+    class sat_batch
+    {
+        private:
+            std::vector<float> _center_a_x, _center_a_y, _half_a_x, _half_a_y, _axis_a_x, _axis_a_y;
+            std::vector<float> _center_b_x, _center_b_y, _half_b_x, _half_b_y, _axis_b_x, _axis_b_y;
+            std::vector<float> _normal_x, _normal_y, _penetration;
+
+        public:
+            sat_batch() = default;
+            ~sat_batch() = default;
+
+            void clear();
+            int add(const obb& a, const obb& b);
+            void run();
+
+            int get_size() const;
+            bool is_colliding(int index) const;
+            glm::vec2 get_normal(int index) const;
+            float get_penetration(int index) const;
+    };
+}
+
+#endif
@@ -0,0 +1,310 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "solidity_grid.h"
+
+engine::physics::solidity_grid::solidity_grid()
+{
+    _width = 0;
+    _height = 0;
+    _tile_size = 1;
+    _words_per_row = 0;
+    _version = 0;
+}
+
+// Resizes the grid to width x height tiles and clears every tile.
+void engine::physics::solidity_grid::resize(int width, int height, int tile_size)
+{
+    _width = width;
+    _height = height;
+    _tile_size = tile_size;
+    _words_per_row = (width + 63) / 64;
+    _bits.assign(static_cast<size_t>(_words_per_row) * height, 0);
+    _version++;
+}
+
+/**
+ * Sizes the grid to a tile map (as wide as its widest row) and makes every tile whose index is one of the blocking
+ * tiles solid.
+ */
+void engine::physics::solidity_grid::load_tiles(const std::vector<std::vector<int>>& tiles, int tile_size, const std::vector<int>& blocking_tiles)
+{
+    int width = 0;
+    for (const std::vector<int>& row: tiles)
+    {
+        width = std::max(width, static_cast<int>(row.size()));
+    }
+
+    resize(width, static_cast<int>(tiles.size()), tile_size);
+    for (int y = 0; y < _height; y++)
+    {
+        for (int x = 0; x < static_cast<int>(tiles[y].size()); x++)
+        {
+            if (std::find(blocking_tiles.begin(), blocking_tiles.end(), tiles[y][x]) != blocking_tiles.end())
+            {
+                set_solid(x, y, true);
+            }
+        }
+    }
+}
+
+void engine::physics::solidity_grid::clear()
+{
+    std::fill(_bits.begin(), _bits.end(), 0);
+    _version++;
+}
+
+int engine::physics::solidity_grid::get_width() const
+{
+    return _width;
+}
+
+int engine::physics::solidity_grid::get_height() const
+{
+    return _height;
+}
+
+int engine::physics::solidity_grid::get_tile_size() const
+{
+    return _tile_size;
+}
+
+// Incremented on every change, so anything derived from the grid can tell when it's out of date.
+unsigned int engine::physics::solidity_grid::get_version() const
+{
+    return _version;
+}
+
+bool engine::physics::solidity_grid::is_inside(int x, int y) const
+{
+    return x >= 0 && y >= 0 && x < _width && y < _height;
+}
+
+bool engine::physics::solidity_grid::is_solid(int x, int y) const
+{
+    if (!is_inside(x, y))
+    {
+        return true;
+    }
+
+    return (_bits[y * _words_per_row + (x >> 6)] >> (x & 63)) & 1;
+}
+
+void engine::physics::solidity_grid::set_solid(int x, int y, bool solid)
+{
+    if (!is_inside(x, y))
+    {
+        return;
+    }
+
+    uint64_t& word = _bits[y * _words_per_row + (x >> 6)];
+    const uint64_t bit = uint64_t(1) << (x & 63);
+    word = solid ? (word | bit) : (word & ~bit);
+    _version++;
+}
+
+// Whether a box in world space touches any solid tile.
+bool engine::physics::solidity_grid::overlaps(const aabb& box) const
+{
+    // Tiles touched by the box. The max edge is exclusive, so a box ending exactly on a tile edge doesn't touch the next tile.
+    const float inverse_tile_size = 1.0f / _tile_size;
+    const int min_x = static_cast<int>(std::floor(box.min.x * inverse_tile_size));
+    const int min_y = static_cast<int>(std::floor(box.min.y * inverse_tile_size));
+    const int max_x = static_cast<int>(std::ceil(box.max.x * inverse_tile_size)) - 1;
+    const int max_y = static_cast<int>(std::ceil(box.max.y * inverse_tile_size)) - 1;
+
+    if (min_x < 0 || min_y < 0 || max_x >= _width || max_y >= _height)
+    {
+        return true;
+    }
+
+    const int first_word = min_x >> 6;
+    const int last_word = max_x >> 6;
+    const uint64_t first_mask = ~uint64_t(0) << (min_x & 63);
+    const uint64_t last_mask = ~uint64_t(0) >> (63 - (max_x & 63));
+
+    for (int y = min_y; y <= max_y; y++)
+    {
+        const uint64_t* row = _bits.data() + y * _words_per_row;
+        for (int word = first_word; word <= last_word; word++)
+        {
+            uint64_t mask = ~uint64_t(0);
+            if (word == first_word)
+            {
+                mask &= first_mask;
+            }
+            if (word == last_word)
+            {
+                mask &= last_mask;
+            }
+
+            if (row[word] & mask)
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Sweeps a box by delta and finds the first solid tile it touches, with the time of impact from 0 to 1 as the hit
+ * distance and the tile's index (y * width + x) as the item, or -1 for the edge of the world. Only tiles under the
+ * swept area are tested.
+ */
+bool engine::physics::solidity_grid::sweep(const aabb& box, const glm::vec2& delta, raycast_hit& hit) const
+{
+    aabb swept = box;
+    swept.expand(aabb(box.min + delta, box.max + delta));
+
+    // Anything further out than one tile past the edge is never reached before that ring of solid tiles.
+    const float inverse_tile_size = 1.0f / _tile_size;
+    const int min_x = std::max(static_cast<int>(std::floor(swept.min.x * inverse_tile_size)), -1);
+    const int min_y = std::max(static_cast<int>(std::floor(swept.min.y * inverse_tile_size)), -1);
+    const int max_x = std::min(static_cast<int>(std::ceil(swept.max.x * inverse_tile_size)) - 1, _width);
+    const int max_y = std::min(static_cast<int>(std::ceil(swept.max.y * inverse_tile_size)) - 1, _height);
+
+    bool has_hit = false;
+    for (int y = min_y; y <= max_y; y++)
+    {
+        for (int x = min_x; x <= max_x; x++)
+        {
+            if (!is_solid(x, y))
+            {
+                continue;
+            }
+
+            const aabb tile(glm::vec2(x * _tile_size, y * _tile_size), glm::vec2((x + 1) * _tile_size, (y + 1) * _tile_size));
+            raycast_hit tile_hit;
+            if (sweep_aabb(box, delta, tile, tile_hit) && (!has_hit || tile_hit.distance < hit.distance))
+            {
+                hit = tile_hit;
+                hit.item = is_inside(x, y) ? y * _width + x : -1;
+                has_hit = true;
+            }
+        }
+    }
+
+    return has_hit;
+}
+
+/**
+ * Walks the tiles along a ray with a DDA (digital differential analyzer) until it reaches a solid tile.
+ * Every step moves to whichever tile boundary is closest along the ray, so each tile crossed is visited exactly once.
+ * The direction must be normalized. The hit item is the index of the solid tile (y * width + x).
+ */
+bool engine::physics::solidity_grid::raycast(const glm::vec2& origin, const glm::vec2& direction, float max_distance, raycast_hit& hit) const
+{
+    const float infinity = std::numeric_limits<float>::infinity();
+
+    // Work in tile units; convert back to world units when reporting.
+    const float inverse_tile_size = 1.0f / _tile_size;
+    const glm::vec2 start = origin * inverse_tile_size;
+    const float max_t = max_distance * inverse_tile_size;
+
+    int x = static_cast<int>(std::floor(start.x));
+    int y = static_cast<int>(std::floor(start.y));
+    const int step_x = direction.x > 0.0f ? 1 : -1;
+    const int step_y = direction.y > 0.0f ? 1 : -1;
+
+    // Distance along the ray to the first vertical and horizontal tile boundary, and between boundaries.
+    const float delta_x = direction.x != 0.0f ? std::fabs(1.0f / direction.x) : infinity;
+    const float delta_y = direction.y != 0.0f ? std::fabs(1.0f / direction.y) : infinity;
+    float next_x = direction.x != 0.0f ? ((x + (step_x > 0 ? 1 : 0)) - start.x) / direction.x : infinity;
+    float next_y = direction.y != 0.0f ? ((y + (step_y > 0 ? 1 : 0)) - start.y) / direction.y : infinity;
+
+    float t = 0.0f;
+    glm::vec2 normal(0.0f, 0.0f);
+    while (!is_solid(x, y))
+    {
+        if (next_x < next_y)
+        {
+            t = next_x;
+            next_x += delta_x;
+            x += step_x;
+            normal = glm::vec2(static_cast<float>(-step_x), 0.0f);
+        }
+        else
+        {
+            t = next_y;
+            next_y += delta_y;
+            y += step_y;
+            normal = glm::vec2(0.0f, static_cast<float>(-step_y));
+        }
+
+        if (t > max_t)
+        {
+            return false;
+        }
+    }
+
+    hit.item = y * _width + x;
+    hit.distance = t * _tile_size;
+    hit.point = origin + direction * hit.distance;
+    hit.normal = normal;
+    return true;
+}
+
+// Whether nothing solid lies on the straight line between two points.
+bool engine::physics::solidity_grid::has_line_of_sight(const glm::vec2& from, const glm::vec2& to) const
+{
+    const glm::vec2 offset = to - from;
+    const float distance = std::sqrt(offset.x * offset.x + offset.y * offset.y);
+    if (distance <= 0.0f)
+    {
+        return !is_solid(static_cast<int>(std::floor(from.x / _tile_size)), static_cast<int>(std::floor(from.y / _tile_size)));
+    }
+
+    raycast_hit hit;
+    return !raycast(from, offset / distance, distance, hit);
+}
+
+/**
+ * Casts many rays in one call. hits and results are resized to match rays; results[i] says whether rays[i] hit.
+ * With stop_at_first_hit, the batch stops as soon as one ray hits (for "is any of these blocked" queries),
+ * leaving the remaining results false. Returns the number of rays that hit.
+ */
+int engine::physics::solidity_grid::raycast_batch(const std::vector<ray>& rays, std::vector<raycast_hit>& hits, std::vector<bool>& results, bool stop_at_first_hit) const
+{
+    const int count = static_cast<int>(rays.size());
+    hits.resize(count);
+    results.assign(count, false);
+
+    int hit_count = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (raycast(rays[i].origin, rays[i].direction, rays[i].max_distance, hits[i]))
+        {
+            results[i] = true;
+            hit_count++;
+            if (stop_at_first_hit)
+            {
+                break;
+            }
+        }
+    }
+
+    return hit_count;
+}
+
+// Line of sight between each pair of points from[i] and to[i]. Returns the number of pairs that can see each other.
+int engine::physics::solidity_grid::line_of_sight_batch(const std::vector<glm::vec2>& from, const std::vector<glm::vec2>& to, std::vector<bool>& visible) const
+{
+    const int count = static_cast<int>(std::min(from.size(), to.size()));
+    visible.assign(count, false);
+
+    int visible_count = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (has_line_of_sight(from[i], to[i]))
+        {
+            visible[i] = true;
+            visible_count++;
+        }
+    }
+
+    return visible_count;
+}
@@ -0,0 +1,67 @@
+#ifndef ENGINE_SOLIDITYGRID_H
+#define ENGINE_SOLIDITYGRID_H
+
+#include <cstdint>
+#include <vector>
+#include <glm/vec2.hpp>
+#include "aabb.h"
+
+namespace engine::physics
+{
+    // Tiles of the jungle tileset that block movement (its water tiles).
+    inline const std::vector<int> JUNGLE_BLOCKING_TILES = { 16, 17, 18, 19, 21 };
+
+    /**
+     * Ray for batched raycasts. Direction must be normalized; distances are in world units.
+     */
+    struct ray
+    {
+        glm::vec2 origin;
+        glm::vec2 direction;
+        float max_distance;
+    };
+
+    /**
+     * Which tiles of a tilemap block movement, packed one bit per tile.
+     *
+     * Each row starts on a new 64 bit word, so a box query only has to mask and test a handful of words per row
+     * instead of looking at every tile. Anything outside the grid counts as solid.
+     */
+    class solidity_grid
+    {
+        private:
+            int _width;
+            int _height;
+            int _tile_size;
+            int _words_per_row;
+            unsigned int _version;
+            std::vector<uint64_t> _bits;
+
+        public:
+            solidity_grid();
+            ~solidity_grid() = default;
+
+            void resize(int width, int height, int tile_size);
+            void load_tiles(const std::vector<std::vector<int>>& tiles, int tile_size, const std::vector<int>& blocking_tiles);
+            void clear();
+
+            int get_width() const;
+            int get_height() const;
+            int get_tile_size() const;
+            unsigned int get_version() const;
+
+            bool is_inside(int x, int y) const;
+            bool is_solid(int x, int y) const;
+            void set_solid(int x, int y, bool solid);
+
+            bool overlaps(const aabb& box) const;
+            bool sweep(const aabb& box, const glm::vec2& delta, raycast_hit& hit) const;
+
+            bool raycast(const glm::vec2& origin, const glm::vec2& direction, float max_distance, raycast_hit& hit) const;
+            bool has_line_of_sight(const glm::vec2& from, const glm::vec2& to) const;
+            int raycast_batch(const std::vector<ray>& rays, std::vector<raycast_hit>& hits, std::vector<bool>& results, bool stop_at_first_hit = false) const;
+            int line_of_sight_batch(const std::vector<glm::vec2>& from, const std::vector<glm::vec2>& to, std::vector<bool>& visible) const;
+    };
+}
+
+#endif
@@ -0,0 +1,175 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "spatial_hash_grid.h"
+
+engine::physics::spatial_hash_grid::spatial_hash_grid(float cell_size)
+{
+    _bucket_mask = 0;
+    _bucket_starts.assign(2, 0);
+    set_cell_size(cell_size);
+}
+
+void engine::physics::spatial_hash_grid::set_cell_size(float cell_size)
+{
+    _cell_size = cell_size;
+    _inverse_cell_size = 1.0f / cell_size;
+}
+
+float engine::physics::spatial_hash_grid::get_cell_size() const
+{
+    return _cell_size;
+}
+
+int engine::physics::spatial_hash_grid::get_item_count() const
+{
+    return static_cast<int>(_boxes.size());
+}
+
+int engine::physics::spatial_hash_grid::to_cell(float coordinate) const
+{
+    return static_cast<int>(std::floor(coordinate * _inverse_cell_size));
+}
+
+unsigned int engine::physics::spatial_hash_grid::get_bucket(int cell_x, int cell_y) const
+{
+    // Large primes keep neighbouring cells from landing in neighbouring buckets.
+    const unsigned int hash = (static_cast<unsigned int>(cell_x) * 73856093u) ^ (static_cast<unsigned int>(cell_y) * 19349663u);
+    return hash & _bucket_mask;
+}
+
+// Rebuilds the grid from scratch. Item IDs are indices into boxes.
+void engine::physics::spatial_hash_grid::build(const std::vector<aabb>& boxes)
+{
+    _boxes = boxes;
+    const int item_count = static_cast<int>(_boxes.size());
+
+    // Size the bucket table to the next power of two above twice the number of items, so chains stay short.
+    unsigned int bucket_count = 16;
+    while (bucket_count < static_cast<unsigned int>(item_count) * 2)
+    {
+        bucket_count <<= 1;
+    }
+    _bucket_mask = bucket_count - 1;
+
+    // First pass: count how many entries land in each bucket.
+    _bucket_starts.assign(bucket_count + 1, 0);
+    int entry_count = 0;
+    for (const aabb& box: _boxes)
+    {
+        const int min_x = to_cell(box.min.x), max_x = to_cell(box.max.x);
+        const int min_y = to_cell(box.min.y), max_y = to_cell(box.max.y);
+        for (int y = min_y; y <= max_y; y++)
+        {
+            for (int x = min_x; x <= max_x; x++)
+            {
+                _bucket_starts[get_bucket(x, y) + 1]++;
+                entry_count++;
+            }
+        }
+    }
+
+    // Prefix sum turns counts into the first entry index of each bucket.
+    for (unsigned int i = 0; i < bucket_count; i++)
+    {
+        _bucket_starts[i + 1] += _bucket_starts[i];
+    }
+
+    // Second pass: scatter entries into their buckets.
+    _entries.resize(entry_count);
+    std::vector<int> cursors(_bucket_starts.begin(), _bucket_starts.end() - 1);
+    for (int item = 0; item < item_count; item++)
+    {
+        const aabb& box = _boxes[item];
+        const int min_x = to_cell(box.min.x), max_x = to_cell(box.max.x);
+        const int min_y = to_cell(box.min.y), max_y = to_cell(box.max.y);
+        for (int y = min_y; y <= max_y; y++)
+        {
+            for (int x = min_x; x <= max_x; x++)
+            {
+                _entries[cursors[get_bucket(x, y)]++] = { x, y, item };
+            }
+        }
+    }
+}
+
+/**
+ * Appends every item overlapping the box to results.
+ *
+ * An item spanning several of the visited cells is only reported from the first cell both it and the query box
+ * cover, which removes duplicates without any per query state.
+ */
+void engine::physics::spatial_hash_grid::query(const aabb& box, std::vector<int>& results) const
+{
+    if (_boxes.empty())
+    {
+        return;
+    }
+
+    const int min_x = to_cell(box.min.x), max_x = to_cell(box.max.x);
+    const int min_y = to_cell(box.min.y), max_y = to_cell(box.max.y);
+    for (int y = min_y; y <= max_y; y++)
+    {
+        for (int x = min_x; x <= max_x; x++)
+        {
+            const unsigned int bucket = get_bucket(x, y);
+            for (int i = _bucket_starts[bucket]; i < _bucket_starts[bucket + 1]; i++)
+            {
+                const cell_entry& entry = _entries[i];
+                if (entry.cell_x != x || entry.cell_y != y)
+                {
+                    continue;
+                }
+
+                const aabb& other = _boxes[entry.item];
+                const int first_x = std::max(min_x, to_cell(other.min.x));
+                const int first_y = std::max(min_y, to_cell(other.min.y));
+                if (first_x == x && first_y == y && box.overlaps(other))
+                {
+                    results.push_back(entry.item);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Appends every overlapping pair of items to pairs, each pair once with the lower item first.
+ * Pairs are found per bucket, so the cost is linear in the number of items when they are spread evenly.
+ */
+void engine::physics::spatial_hash_grid::find_pairs(std::vector<std::pair<int, int>>& pairs) const
+{
+    const unsigned int bucket_count = _bucket_mask + 1;
+    for (unsigned int bucket = 0; bucket < bucket_count; bucket++)
+    {
+        const int start = _bucket_starts[bucket];
+        const int end = _bucket_starts[bucket + 1];
+        for (int i = start; i < end; i++)
+        {
+            const cell_entry& a = _entries[i];
+            const aabb& box_a = _boxes[a.item];
+            for (int j = i + 1; j < end; j++)
+            {
+                const cell_entry& b = _entries[j];
+                if (a.cell_x != b.cell_x || a.cell_y != b.cell_y)
+                {
+                    continue;
+                }
+
+                const aabb& box_b = _boxes[b.item];
+                if (!box_a.overlaps(box_b))
+                {
+                    continue;
+                }
+
+                // Only report the pair from the first cell both boxes share.
+                const int first_x = std::max(to_cell(box_a.min.x), to_cell(box_b.min.x));
+                const int first_y = std::max(to_cell(box_a.min.y), to_cell(box_b.min.y));
+                if (first_x == a.cell_x && first_y == a.cell_y)
+                {
+                    pairs.push_back(std::make_pair(std::min(a.item, b.item), std::max(a.item, b.item)));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef ENGINE_SPATIALHASHGRID_H
+#define ENGINE_SPATIALHASHGRID_H
+
+#include <utility>
+#include <vector>
+#include "aabb.h"
+
+namespace engine::physics
+{
+    /**
+     * Uniform grid broadphase over a hashed, unbounded set of cells.
+     *
+     * Items are boxes identified by their index in the vector passed to build(). Every build is a counting sort of
+     * (cell, item) entries into hash buckets, so it runs in linear time and leaves each bucket contiguous in memory.
+     * Lookups are read only and safe to run from several threads at once.
+     */
+    class spatial_hash_grid
+    {
+        private:
+            struct cell_entry
+            {
+                int cell_x;
+                int cell_y;
+                int item;
+            };
+
+            float _cell_size;
+            float _inverse_cell_size;
+            unsigned int _bucket_mask;
+
+            std::vector<aabb> _boxes;
+            std::vector<int> _bucket_starts;
+            std::vector<cell_entry> _entries;
+
+            int to_cell(float coordinate) const;
+            unsigned int get_bucket(int cell_x, int cell_y) const;
+
+        public:
+            spatial_hash_grid(float cell_size = 64.0f);
+            ~spatial_hash_grid() = default;
+
+            void set_cell_size(float cell_size);
+            float get_cell_size() const;
+            int get_item_count() const;
+
+            void build(const std::vector<aabb>& boxes);
+            void query(const aabb& box, std::vector<int>& results) const;
+            void find_pairs(std::vector<std::pair<int, int>>& pairs) const;
+    };
+}
+
+#endif
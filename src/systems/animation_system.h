@@ -0,0 +1,129 @@
+#ifndef ENGINE_ANIMATIONSYSTEM_H
+#define ENGINE_ANIMATIONSYSTEM_H
+
+#include <algorithm>
+#include <vector>
+#include "../animation.h"
+#include "../ecs.h"
+#include "../components/animation_component.h"
+#include "../components/sprite_component.h"
+
+namespace engine::systems
+{
+    /**
+     * Advances sprite sheet animations.
+     *
+     * Playback state is gathered into contiguous arrays and advanced for every animated sprite at once by a
+     * branch free loop the compiler vectorizes. Looping clips wrap their time instead of letting it grow.
+     * A sprite's source rectangle is only written when its frame actually changes, or its clip does.
+     */
+    class animation_system: public ecs::system
+    {
+        private:
+            const animation_library* _library = nullptr;
+
+            std::vector<ecs::entity> _entities;
+            std::vector<float> _times;
+            std::vector<float> _speeds;
+            std::vector<float> _inverse_durations;
+            std::vector<float> _clip_lengths;
+            std::vector<float> _loops;
+            std::vector<int> _last_frames;
+            std::vector<int> _frames;
+
+            static void advance(
+                int count, float delta_time,
+                float* __restrict times, const float* __restrict speeds,
+                const float* __restrict inverse_durations, const float* __restrict clip_lengths,
+                const float* __restrict loops, const int* __restrict last_frames, int* __restrict frames)
+            {
+                for (int i = 0; i < count; i++)
+                {
+                    // Times are never negative, so truncating is flooring. Non-looping clips (loops of 0) keep going.
+                    float time = times[i] + delta_time * speeds[i];
+                    time -= loops[i] * static_cast<float>(static_cast<int>(time / clip_lengths[i])) * clip_lengths[i];
+                    times[i] = time;
+                    frames[i] = std::min(static_cast<int>(time * inverse_durations[i]), last_frames[i]);
+                }
+            }
+
+        public:
+            animation_system()
+            {
+                require_component<components::sprite_component>();
+                require_component<components::animation_component>();
+            }
+
+            void set_library(const animation_library* library)
+            {
+                _library = library;
+            }
+
+            void update(const double delta_time)
+            {
+                if (!_library)
+                {
+                    return;
+                }
+
+                _entities.clear();
+                _times.clear();
+                _speeds.clear();
+                _inverse_durations.clear();
+                _clip_lengths.clear();
+                _loops.clear();
+                _last_frames.clear();
+                for (const ecs::entity entity: get_system_entities())
+                {
+                    components::animation_component& animation = entity.get_component<components::animation_component>();
+                    if (animation.clip < 0)
+                    {
+                        continue;
+                    }
+
+                    // A new clip starts over, and its first frame has to be written even if the index matches.
+                    if (animation.clip != animation.playing_clip)
+                    {
+                        animation.playing_clip = animation.clip;
+                        animation.time = 0.0f;
+                        animation.frame = -1;
+                    }
+
+                    const animation_clip& clip = _library->get_clip(animation.clip);
+                    if (clip.frame_count == 0)
+                    {
+                        continue;
+                    }
+
+                    _entities.push_back(entity);
+                    _times.push_back(animation.time);
+                    _speeds.push_back(std::max(animation.speed, 0.0f));
+                    _inverse_durations.push_back(1.0f / clip.frame_duration);
+                    _clip_lengths.push_back(clip.frame_duration * clip.frame_count);
+                    _loops.push_back(clip.loops ? 1.0f : 0.0f);
+                    _last_frames.push_back(std::max(clip.frame_count - 1, 0));
+                }
+
+                const int count = static_cast<int>(_entities.size());
+                _frames.resize(count);
+                advance(
+                    count, static_cast<float>(delta_time),
+                    _times.data(), _speeds.data(), _inverse_durations.data(), _clip_lengths.data(),
+                    _loops.data(), _last_frames.data(), _frames.data()
+                );
+
+                for (int i = 0; i < count; i++)
+                {
+                    components::animation_component& animation = _entities[i].get_component<components::animation_component>();
+                    animation.time = _times[i];
+                    if (animation.frame != _frames[i])
+                    {
+                        animation.frame = _frames[i];
+                        _entities[i].get_component<components::sprite_component>().src_rect = _library->get_frame(_library->get_clip(animation.clip).first_frame + _frames[i]);
+                    }
+                }
+            }
+    };
+}
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef ENGINE_CAMERASYSTEM_H
+#define ENGINE_CAMERASYSTEM_H
+
+#include <algorithm>
+#include <vector>
+#include "../aabb.h"
+#include "../ecs.h"
+#include "../components/camera_component.h"
+#include "../components/transform_component.h"
+
+namespace engine::systems
+{
+    /**
+     * Positions cameras and works out the world area each one sees.
+     * A camera's transform position is the center of its view. Runs once per rendered frame, before rendering,
+     * so cameras follow the same interpolated positions that are drawn.
+     */
+    class camera_system: public ecs::system
+    {
+        private:
+            // Centers the view on the bounds along an axis they don't cover, otherwise keeps it inside them.
+            static float clamp_axis(float center, float half_size, float bounds_min, float bounds_max)
+            {
+                if (bounds_max - bounds_min <= half_size * 2.0f)
+                {
+                    return (bounds_min + bounds_max) * 0.5f;
+                }
+
+                return std::clamp(center, bounds_min + half_size, bounds_max - half_size);
+            }
+
+        public:
+            camera_system()
+            {
+                require_component<components::transform_component>();
+                require_component<components::camera_component>();
+            }
+
+            void update(const double alpha = 1.0)
+            {
+                for (const ecs::entity entity: get_system_entities())
+                {
+                    components::transform_component& transform = entity.get_component<components::transform_component>();
+                    components::camera_component& camera = entity.get_component<components::camera_component>();
+
+                    if (camera.target_id >= 0)
+                    {
+                        ecs::entity target(camera.target_id);
+                        target.registry = entity.registry;
+                        if (target.has_component<components::transform_component>())
+                        {
+                            const components::transform_component& target_transform = target.get_component<components::transform_component>();
+                            transform.position = target_transform.previous_position + (target_transform.position - target_transform.previous_position) * static_cast<float>(alpha) + camera.target_offset;
+                        }
+                    }
+
+                    const glm::vec2 half_size = camera.viewport / (camera.zoom * 2.0f);
+                    if (camera.bounds_max.x > camera.bounds_min.x && camera.bounds_max.y > camera.bounds_min.y)
+                    {
+                        transform.position.x = clamp_axis(transform.position.x, half_size.x, camera.bounds_min.x, camera.bounds_max.x);
+                        transform.position.y = clamp_axis(transform.position.y, half_size.y, camera.bounds_min.y, camera.bounds_max.y);
+                    }
+
+                    transform.previous_position = transform.position;
+                    camera.view = physics::aabb(transform.position - half_size, transform.position + half_size);
+                }
+            }
+
+            // The first camera, or nullptr if there isn't one.
+            const components::camera_component* get_camera() const
+            {
+                const std::vector<ecs::entity> entities = get_system_entities();
+                if (entities.empty())
+                {
+                    return nullptr;
+                }
+
+                return &entities.front().get_component<components::camera_component>();
+            }
+    };
+}
+
+#endif
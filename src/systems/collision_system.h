@@ -0,0 +1,347 @@
+#ifndef ENGINE_COLLISIONSYSTEM_H
+#define ENGINE_COLLISIONSYSTEM_H
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "../aabb.h"
+#include "../bvh.h"
+#include "../ecs.h"
+#include "../logger.h"
+#include "../sat.h"
+#include "../solidity_grid.h"
+#include "../spatial_hash_grid.h"
+#include "../components/box_collider_component.h"
+#include "../components/transform_component.h"
+
+namespace engine::systems
+{
+    /**
+     * Pair of entities whose colliders overlap.
+     * The normal points from a to b, and penetration is how far they'd have to move apart along it to separate.
+     */
+    struct contact_pair
+    {
+        ecs::entity a;
+        ecs::entity b;
+        glm::vec2 normal;
+        float penetration;
+    };
+
+    /**
+     * First hit of a continuous collider along its motion this tick.
+     * Time of impact goes from 0 (start of the tick) to 1 (end of the tick) and the normal points away from the other collider.
+     * For hits on solid tiles, other is the mover itself.
+     */
+    struct swept_contact
+    {
+        ecs::entity mover;
+        ecs::entity other;
+        float time_of_impact;
+        glm::vec2 normal;
+    };
+
+    /**
+     * Finds overlapping box colliders every tick.
+     * Dynamic colliders are rebuilt into a uniform spatial hash grid every tick, while static colliders are built
+     * into a bounding volume hierarchy once by build_static(). The candidate pairs both produce are then confirmed
+     * by one batch of separating axis tests on the rotated boxes, and the resulting contacts are kept as one batch,
+     * valid until the next update().
+     *
+     * If a tile grid is set, every dynamic collider is also tested against its solid tiles.
+     *
+     * Continuous colliders are left out of the discrete tests. Instead, all of them are swept from their previous
+     * position to their current one in a single pass after the broadphase is built, against static colliders,
+     * dynamic colliders, solid tiles and each other, and are moved back to their first point of impact. They are
+     * swept against each other pair by pair, which is fine for the handful of fast movers they are meant for.
+     */
+    class collision_system: public ecs::system
+    {
+        private:
+            physics::spatial_hash_grid _grid;
+            physics::bvh _static_bvh;
+
+            std::vector<ecs::entity> _entities;
+            std::vector<ecs::entity> _static_entities;
+            std::vector<physics::obb> _static_obbs;
+            std::vector<physics::aabb> _boxes;
+            std::vector<physics::obb> _obbs;
+            std::vector<glm::vec2> _deltas;
+            std::vector<std::pair<int, int>> _pairs;
+            std::vector<int> _static_results;
+            std::vector<contact_pair> _candidates;
+            std::vector<contact_pair> _contacts;
+            physics::sat_batch _narrowphase;
+
+            const physics::solidity_grid* _tile_grid = nullptr;
+            std::vector<ecs::entity> _tile_contacts;
+
+            std::vector<ecs::entity> _continuous_entities;
+            std::vector<physics::aabb> _continuous_boxes;
+            std::vector<glm::vec2> _continuous_deltas;
+            std::vector<int> _continuous_candidates;
+            std::vector<swept_contact> _swept_contacts;
+
+            // Moves each continuous collider back a little from its time of impact so it ends up touching, not overlapping.
+            static constexpr float IMPACT_EPSILON = 0.001f;
+
+            void sweep_continuous()
+            {
+                _swept_contacts.clear();
+
+                for (int i = 0; i < static_cast<int>(_continuous_entities.size()); i++)
+                {
+                    const physics::aabb& start = _continuous_boxes[i];
+                    const glm::vec2 delta = _continuous_deltas[i];
+                    if (delta.x == 0.0f && delta.y == 0.0f)
+                    {
+                        continue;
+                    }
+
+                    bool has_hit = false;
+                    swept_contact closest = { _continuous_entities[i], _continuous_entities[i], 1.0f, glm::vec2(0.0f, 0.0f) };
+
+                    physics::raycast_hit hit;
+                    if (_static_bvh.sweep(start, delta, hit))
+                    {
+                        has_hit = true;
+                        closest = { _continuous_entities[i], _static_entities[hit.item], hit.distance, hit.normal };
+                    }
+
+                    // Dynamic colliders, tested with the motion relative to theirs over the tick.
+                    physics::aabb swept_box = start;
+                    swept_box.expand(physics::aabb(start.min + delta, start.max + delta));
+                    _continuous_candidates.clear();
+                    _grid.query(swept_box, _continuous_candidates);
+                    for (const int item: _continuous_candidates)
+                    {
+                        const physics::aabb other_start(_boxes[item].min - _deltas[item], _boxes[item].max - _deltas[item]);
+                        if (physics::sweep_aabb(start, delta - _deltas[item], other_start, hit) && hit.distance < closest.time_of_impact)
+                        {
+                            has_hit = true;
+                            closest = { _continuous_entities[i], _entities[item], hit.distance, hit.normal };
+                        }
+                    }
+
+                    // Other continuous colliders, again with the relative motion.
+                    for (int j = 0; j < static_cast<int>(_continuous_entities.size()); j++)
+                    {
+                        if (j != i && physics::sweep_aabb(start, delta - _continuous_deltas[j], _continuous_boxes[j], hit) && hit.distance < closest.time_of_impact)
+                        {
+                            has_hit = true;
+                            closest = { _continuous_entities[i], _continuous_entities[j], hit.distance, hit.normal };
+                        }
+                    }
+
+                    // Solid tiles have no entity, so the mover is reported as the other side too.
+                    if (_tile_grid && _tile_grid->sweep(start, delta, hit) && hit.distance < closest.time_of_impact)
+                    {
+                        has_hit = true;
+                        closest = { _continuous_entities[i], _continuous_entities[i], hit.distance, hit.normal };
+                    }
+
+                    if (has_hit)
+                    {
+                        _swept_contacts.push_back(closest);
+                    }
+                }
+
+                // Apply impacts only after every sweep is done, so results don't depend on processing order.
+                for (const swept_contact& contact: _swept_contacts)
+                {
+                    components::transform_component& transform = contact.mover.get_component<components::transform_component>();
+                    const glm::vec2 delta = transform.position - transform.previous_position;
+                    const float time = contact.time_of_impact > IMPACT_EPSILON ? contact.time_of_impact - IMPACT_EPSILON : 0.0f;
+                    transform.position = transform.previous_position + delta * time;
+                }
+            }
+
+        public:
+            collision_system(float cell_size = 64.0f): _grid(cell_size)
+            {
+                require_component<components::transform_component>();
+                require_component<components::box_collider_component>();
+            }
+
+            // Collider box rotated with the transform around its own center.
+            static physics::obb get_collider_obb(const components::transform_component& transform, const components::box_collider_component& collider)
+            {
+                const glm::vec2 min = transform.position + collider.offset * transform.scale;
+                const glm::vec2 size = glm::vec2(collider.width, collider.height) * transform.scale;
+                return physics::obb::from_aabb(physics::aabb(min, min + size), transform.rotation);
+            }
+
+            // Axis aligned bounds of the rotated collider box, used by the broadphase.
+            static physics::aabb get_collider_box(const components::transform_component& transform, const components::box_collider_component& collider)
+            {
+                return get_collider_obb(transform, collider).get_bounds();
+            }
+
+            /**
+             * Builds every static collider into the static hierarchy. Call once after a level is loaded;
+             * static colliders added later are ignored until this is called again.
+             */
+            void build_static()
+            {
+                _static_entities.clear();
+                _static_obbs.clear();
+                std::vector<physics::aabb> boxes;
+                for (const ecs::entity entity: get_system_entities())
+                {
+                    const components::box_collider_component& collider = entity.get_component<components::box_collider_component>();
+                    if (collider.is_static)
+                    {
+                        const physics::obb obb = get_collider_obb(entity.get_component<components::transform_component>(), collider);
+                        _static_entities.push_back(entity);
+                        _static_obbs.push_back(obb);
+                        boxes.push_back(obb.get_bounds());
+                    }
+                }
+
+                _static_bvh.build(boxes);
+
+                logger::log("Static collision hierarchy built with " + std::to_string(boxes.size()) + " colliders and " + std::to_string(_static_bvh.get_node_count()) + " nodes.");
+            }
+
+            void update()
+            {
+                // Gather dynamic boxes into contiguous arrays before building the grid.
+                _entities.clear();
+                _boxes.clear();
+                _obbs.clear();
+                _deltas.clear();
+                _continuous_entities.clear();
+                _continuous_boxes.clear();
+                _continuous_deltas.clear();
+                for (const ecs::entity entity: get_system_entities())
+                {
+                    const components::box_collider_component& collider = entity.get_component<components::box_collider_component>();
+                    if (collider.is_static)
+                    {
+                        continue;
+                    }
+
+                    const components::transform_component& transform = entity.get_component<components::transform_component>();
+                    const glm::vec2 delta = transform.position - transform.previous_position;
+                    const physics::obb obb = get_collider_obb(transform, collider);
+                    const physics::aabb box = obb.get_bounds();
+                    if (collider.is_continuous)
+                    {
+                        // Continuous colliders are swept from where they started the tick.
+                        _continuous_entities.push_back(entity);
+                        _continuous_boxes.push_back(physics::aabb(box.min - delta, box.max - delta));
+                        _continuous_deltas.push_back(delta);
+                        continue;
+                    }
+
+                    _entities.push_back(entity);
+                    _boxes.push_back(box);
+                    _obbs.push_back(obb);
+                    _deltas.push_back(delta);
+                }
+
+                _grid.build(_boxes);
+
+                _pairs.clear();
+                _grid.find_pairs(_pairs);
+
+                // Queue every broadphase pair for the narrowphase.
+                _candidates.clear();
+                _narrowphase.clear();
+                for (const std::pair<int, int>& pair: _pairs)
+                {
+                    _candidates.push_back({ _entities[pair.first], _entities[pair.second], glm::vec2(0.0f, 0.0f), 0.0f });
+                    _narrowphase.add(_obbs[pair.first], _obbs[pair.second]);
+                }
+
+                // Dynamic against static pairs. The static entity is always second.
+                for (int i = 0; i < static_cast<int>(_boxes.size()); i++)
+                {
+                    _static_results.clear();
+                    _static_bvh.query(_boxes[i], _static_results);
+                    for (const int item: _static_results)
+                    {
+                        _candidates.push_back({ _entities[i], _static_entities[item], glm::vec2(0.0f, 0.0f), 0.0f });
+                        _narrowphase.add(_obbs[i], _static_obbs[item]);
+                    }
+                }
+
+                // Separating axis tests on all pairs at once. Only pairs whose rotated boxes really overlap are kept.
+                _narrowphase.run();
+                _contacts.clear();
+                for (int i = 0; i < static_cast<int>(_candidates.size()); i++)
+                {
+                    if (_narrowphase.is_colliding(i))
+                    {
+                        contact_pair contact = _candidates[i];
+                        contact.normal = _narrowphase.get_normal(i);
+                        contact.penetration = _narrowphase.get_penetration(i);
+                        _contacts.push_back(contact);
+                    }
+                }
+
+                // Tile contacts, tested against the bit packed grid rather than one collider per tile.
+                _tile_contacts.clear();
+                if (_tile_grid)
+                {
+                    for (int i = 0; i < static_cast<int>(_boxes.size()); i++)
+                    {
+                        if (_tile_grid->overlaps(_boxes[i]))
+                        {
+                            _tile_contacts.push_back(_entities[i]);
+                        }
+                    }
+                }
+
+                sweep_continuous();
+            }
+
+            // Solid tiles to test colliders against. The grid must outlive the system, or be unset with nullptr.
+            void set_tile_grid(const physics::solidity_grid* tile_grid)
+            {
+                _tile_grid = tile_grid;
+            }
+
+            // Dynamic entities touching a solid tile in the most recent update().
+            const std::vector<ecs::entity>& get_tile_contacts() const
+            {
+                return _tile_contacts;
+            }
+
+            // First impacts of continuous colliders found by the most recent update().
+            const std::vector<swept_contact>& get_swept_contacts() const
+            {
+                return _swept_contacts;
+            }
+
+            // Finds the closest static collider hit by a ray. The entity hit is written to hit_entity.
+            bool raycast_static(const glm::vec2& origin, const glm::vec2& direction, float max_distance, physics::raycast_hit& hit, ecs::entity& hit_entity) const
+            {
+                if (!_static_bvh.raycast(origin, direction, max_distance, hit))
+                {
+                    return false;
+                }
+
+                hit_entity = _static_entities[hit.item];
+                return true;
+            }
+
+            const physics::bvh& get_static_bvh() const
+            {
+                return _static_bvh;
+            }
+
+            // Contacts found by the most recent update().
+            const std::vector<contact_pair>& get_contacts() const
+            {
+                return _contacts;
+            }
+
+            const physics::spatial_hash_grid& get_grid() const
+            {
+                return _grid;
+            }
+    };
+}
+
+#endif
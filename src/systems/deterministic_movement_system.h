@@ -0,0 +1,118 @@
+#ifndef ENGINE_DETERMINISTICMOVEMENTSYSTEM_H
+#define ENGINE_DETERMINISTICMOVEMENTSYSTEM_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "../ecs.h"
+#include "../fixed_point.h"
+#include "../components/fixed_body_component.h"
+#include "../components/transform_component.h"
+
+namespace engine::systems
+{
+    /**
+     * Bit-exact replacement for the movement system, used for lockstep sessions and replays.
+     *
+     * Positions and velocities are integrated in fixed point with a fixed tick, entities are always processed in ID
+     * order, and a checksum of the simulated state is produced every tick so diverging peers can be detected.
+     *
+     * There is no collision response in this mode, so bodies reaching the edge of the world stop there instead of
+     * travelling on until their fixed point positions overflow.
+     */
+    class deterministic_movement_system: public ecs::system
+    {
+        private:
+            uint64_t _checksum = 0;
+            fixed_vec2 _world_min;
+            fixed_vec2 _world_max = fixed_vec2(fixed::from_int(1 << 20), fixed::from_int(1 << 20));
+
+            // FNV-1a, fed one 32 bit value at a time.
+            static uint64_t hash(uint64_t checksum, uint32_t value)
+            {
+                for (int i = 0; i < 4; i++)
+                {
+                    checksum ^= (value >> (i * 8)) & 0xFF;
+                    checksum *= 1099511628211ull;
+                }
+                return checksum;
+            }
+
+            static uint64_t hash(uint64_t checksum, fixed value)
+            {
+                const uint64_t bits = static_cast<uint64_t>(value.raw);
+                checksum = hash(checksum, static_cast<uint32_t>(bits));
+                return hash(checksum, static_cast<uint32_t>(bits >> 32));
+            }
+
+            // Clamps one axis of a body to the world, stopping it along that axis if it got out.
+            static void clamp_axis(fixed& position, fixed& velocity, fixed min, fixed max)
+            {
+                if (position < min)
+                {
+                    position = min;
+                    velocity = fixed();
+                }
+                else if (position > max)
+                {
+                    position = max;
+                    velocity = fixed();
+                }
+            }
+
+        public:
+            deterministic_movement_system()
+            {
+                require_component<components::transform_component>();
+                require_component<components::fixed_body_component>();
+            }
+
+            // Area bodies may move in, in world units.
+            void set_world_bounds(const fixed_vec2& min, const fixed_vec2& max)
+            {
+                _world_min = min;
+                _world_max = max;
+            }
+
+            void update(const fixed delta_time)
+            {
+                std::vector<ecs::entity> entities = get_system_entities();
+                if (!std::is_sorted(entities.begin(), entities.end()))
+                {
+                    std::sort(entities.begin(), entities.end());
+                }
+
+                uint64_t checksum = 14695981039346656037ull;
+                for (const ecs::entity entity: entities)
+                {
+                    components::fixed_body_component& body = entity.get_component<components::fixed_body_component>();
+                    components::transform_component& transform = entity.get_component<components::transform_component>();
+
+                    body.position += body.velocity * delta_time;
+                    clamp_axis(body.position.x, body.velocity.x, _world_min.x, _world_max.x);
+                    clamp_axis(body.position.y, body.velocity.y, _world_min.y, _world_max.y);
+
+                    // The transform is only a view of the fixed point state for rendering.
+                    transform.previous_position = transform.position;
+                    transform.previous_rotation = transform.rotation;
+                    transform.position = body.position.to_vec2();
+
+                    checksum = hash(checksum, static_cast<uint32_t>(entity.get_id()));
+                    checksum = hash(checksum, body.position.x);
+                    checksum = hash(checksum, body.position.y);
+                    checksum = hash(checksum, body.velocity.x);
+                    checksum = hash(checksum, body.velocity.y);
+                }
+
+                _checksum = checksum;
+            }
+
+            // Checksum of the state simulated by the most recent update().
+            uint64_t get_checksum() const
+            {
+                return _checksum;
+            }
+    };
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef ENGINE_FLOWFIELDSYSTEM_H
+#define ENGINE_FLOWFIELDSYSTEM_H
+
+#include <memory>
+#include "../ecs.h"
+#include "../flow_field.h"
+#include "../components/flow_field_component.h"
+#include "../components/rigidbody_component.h"
+#include "../components/transform_component.h"
+
+namespace engine::systems
+{
+    /**
+     * Steers entities towards their goal tile by setting their velocity from a shared flow field.
+     * Entities standing on their goal, or on a tile that can't reach it, stop.
+     *
+     * Fields change slowly along a path, so with an update interval each tick only refreshes one slice of the
+     * entities (see get_staggered_entities()); the rest keep their last velocity until their turn comes around.
+     */
+    class flow_field_system: public ecs::system
+    {
+        private:
+            navigation::flow_field_cache* _fields = nullptr;
+
+        public:
+            flow_field_system()
+            {
+                require_component<components::transform_component>();
+                require_component<components::rigidbody_component>();
+                require_component<components::flow_field_component>();
+            }
+
+            void set_field_cache(navigation::flow_field_cache* fields)
+            {
+                _fields = fields;
+            }
+
+            void update(const unsigned long long tick)
+            {
+                if (!_fields)
+                {
+                    return;
+                }
+
+                // Units tend to share goals, so only look up the cache when the goal changes.
+                std::shared_ptr<const navigation::flow_field> field;
+                for (const ecs::entity entity: get_staggered_entities(tick))
+                {
+                    const components::flow_field_component& flow = entity.get_component<components::flow_field_component>();
+                    if (!field || field->get_goal() != flow.goal)
+                    {
+                        field = _fields->get(flow.goal);
+                    }
+
+                    const components::transform_component& transform = entity.get_component<components::transform_component>();
+                    components::rigidbody_component& rigidbody = entity.get_component<components::rigidbody_component>();
+                    rigidbody.velocity = field->sample(transform.position + flow.anchor) * flow.speed;
+                }
+            }
+    };
+}
+
+#endif
@@ -8,6 +8,10 @@
 
 namespace engine::systems
 {
+    /**
+     * Moves entities by their velocity. Runs every tick: rendering interpolates between the previous and latest
+     * tick, which only works if positions advance on every one of them.
+     */
     class movement_system: public ecs::system
     {
         public:
@@ -24,6 +28,10 @@ namespace engine::systems
                     const components::rigidbody_component rigidbody = entity.get_component<components::rigidbody_component>();
                     components::transform_component& transform = entity.get_component<components::transform_component>();
 
+                    // Remember where this tick started so the renderer can interpolate towards the new position.
+                    transform.previous_position = transform.position;
+                    transform.previous_rotation = transform.rotation;
+
                     transform.position.x += rigidbody.velocity.x * delta_time;
                     transform.position.y += rigidbody.velocity.y * delta_time;
                 }
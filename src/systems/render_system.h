@@ -1,17 +1,172 @@
 #ifndef ENGINE_RENDERSYSTEM_H
 #define ENGINE_RENDERSYSTEM_H
 
+#include <cmath>
+#include <cstdint>
 #include <vector>
 #include <SDL2/SDL.h>
+#include "../aabb.h"
 #include "../ecs.h"
+#include "../render_frame.h"
+#include "../render_queue.h"
 #include "../resources.h"
+#include "../spatial_hash_grid.h"
+#include "../components/camera_component.h"
 #include "../components/sprite_component.h"
 #include "../components/transform_component.h"
 
 namespace engine::systems
 {
+    // Running totals of what the render system has drawn.
+    struct render_stats
+    {
+        unsigned long long frames;
+        unsigned long long draw_calls;
+        unsigned long long sprites;
+        int last_draw_calls;
+    };
+
+    /**
+     * Draws sprites in batches instead of one copy per sprite.
+     *
+     * Drawing is split in two steps. build() pushes every sprite into a render queue keyed by layer, texture,
+     * depth (the sprite's bottom edge) and sequence, radix sorts it, and turns the sprites into rotated and scaled
+     * quads, computed on the CPU, in that order. Texture ranks above depth, so lower sprites only overlap higher
+     * ones when they share a texture; sprites on different textures that must overlap properly need different
+     * layers. Consecutive quads sharing a layer and texture form a group. submit() then draws each group with one
+     * SDL_RenderGeometry call, so a frame costs one draw call per texture per layer no matter how many sprites
+     * there are. With images packed into atlas pages, sprites using different images usually share a texture too.
+     *
+     * Given a camera, sprites are drawn relative to its view and scaled by its zoom, and sprites outside the view
+     * are skipped. Static sprites are indexed once in a spatial hash grid, so only the cells under the view are
+     * visited. Moving sprites are tested against the view one by one, so their cost grows with how many there are
+     * rather than with how many are on screen.
+     */
     class render_system: public ecs::system
     {
+        private:
+            struct sprite_instance
+            {
+                int layer;
+                SDL_Texture* texture;
+                int texture_index;
+                int texture_width;
+                int texture_height;
+                glm::vec2 position;
+                glm::vec2 size;
+                double rotation;
+                SDL_Rect src_rect;
+            };
+
+            std::vector<sprite_instance> _instances;
+            render_queue _queue;
+
+            physics::spatial_hash_grid _static_grid;
+            std::vector<ecs::entity> _static_entities;
+            std::vector<physics::aabb> _static_boxes;
+            std::vector<int> _visible_static;
+            // Entities version the static grid was built for. Starts out of date so the first frame builds it.
+            unsigned int _indexed_version = ~0u;
+            render_frame _frame;
+            render_stats _stats = { 0, 0, 0, 0 };
+
+            // Bounds of a sprite at any rotation.
+            static physics::aabb get_sprite_bounds(const components::transform_component& transform, const components::sprite_component& sprite)
+            {
+                const glm::vec2 half(sprite.width * transform.scale.x * 0.5f, sprite.height * transform.scale.y * 0.5f);
+                const float radius = std::sqrt(half.x * half.x + half.y * half.y);
+                const glm::vec2 center = transform.position + half;
+                return physics::aabb(center - glm::vec2(radius, radius), center + glm::vec2(radius, radius));
+            }
+
+            // Indexes every static sprite. Only needed when sprites were added or removed, as static ones never move.
+            void index_static(const std::vector<ecs::entity>& entities)
+            {
+                _static_entities.clear();
+                _static_boxes.clear();
+                for (const ecs::entity entity: entities)
+                {
+                    const components::sprite_component& sprite = entity.get_component<components::sprite_component>();
+                    if (sprite.is_static)
+                    {
+                        _static_entities.push_back(entity);
+                        _static_boxes.push_back(get_sprite_bounds(entity.get_component<components::transform_component>(), sprite));
+                    }
+                }
+
+                _static_grid.build(_static_boxes);
+                _indexed_version = get_entities_version();
+            }
+
+            void add_instance(const ecs::entity entity, const double alpha)
+            {
+                const components::transform_component& transform = entity.get_component<components::transform_component>();
+                const components::sprite_component& sprite = entity.get_component<components::sprite_component>();
+
+                // Source rectangles are relative to the sprite's image, which may sit anywhere on an atlas page.
+                const resources::texture_region& region = resources::get_texture_region(sprite.texture);
+
+                sprite_instance instance;
+                instance.layer = sprite.layer;
+                instance.texture = region.texture;
+                instance.texture_index = region.texture_index;
+                instance.texture_width = region.texture_width;
+                instance.texture_height = region.texture_height;
+                instance.position = transform.previous_position + (transform.position - transform.previous_position) * static_cast<float>(alpha);
+                instance.size = glm::vec2(sprite.width * transform.scale.x, sprite.height * transform.scale.y);
+                instance.rotation = transform.previous_rotation + (transform.rotation - transform.previous_rotation) * alpha;
+                instance.src_rect = sprite.src_rect;
+                instance.src_rect.x += region.rect.x;
+                instance.src_rect.y += region.rect.y;
+                if (instance.texture)
+                {
+                    _instances.push_back(instance);
+                }
+            }
+
+            static void add_quad(render_frame& frame, const sprite_instance& instance, const glm::vec2& view_origin, float zoom)
+            {
+                // SDL_RenderCopyEx rotates clockwise, in degrees, around the center of the destination rectangle.
+                const double radians = instance.rotation * 3.14159265358979323846 / 180.0;
+                const float cos_rotation = static_cast<float>(std::cos(radians));
+                const float sin_rotation = static_cast<float>(std::sin(radians));
+                const glm::vec2 half = instance.size * 0.5f;
+                const glm::vec2 center = instance.position + half;
+
+                const float texture_width = static_cast<float>(instance.texture_width);
+                const float texture_height = static_cast<float>(instance.texture_height);
+                const float u0 = instance.src_rect.x / texture_width;
+                const float v0 = instance.src_rect.y / texture_height;
+                const float u1 = (instance.src_rect.x + instance.src_rect.w) / texture_width;
+                const float v1 = (instance.src_rect.y + instance.src_rect.h) / texture_height;
+
+                const glm::vec2 corners[4] = {
+                    glm::vec2(-half.x, -half.y),
+                    glm::vec2(half.x, -half.y),
+                    glm::vec2(half.x, half.y),
+                    glm::vec2(-half.x, half.y)
+                };
+                const SDL_FPoint tex_coords[4] = { { u0, v0 }, { u1, v0 }, { u1, v1 }, { u0, v1 } };
+                const SDL_Color color = { 255, 255, 255, 255 };
+
+                sprite_batch& batch = frame.batches.back();
+                const int first = batch.vertex_count;
+                for (int i = 0; i < 4; i++)
+                {
+                    const SDL_FPoint position = {
+                        (center.x + corners[i].x * cos_rotation - corners[i].y * sin_rotation - view_origin.x) * zoom,
+                        (center.y + corners[i].x * sin_rotation + corners[i].y * cos_rotation - view_origin.y) * zoom
+                    };
+                    frame.vertices.push_back({ position, color, tex_coords[i] });
+                }
+
+                const int indices[6] = { first, first + 1, first + 2, first, first + 2, first + 3 };
+                frame.indices.insert(frame.indices.end(), indices, indices + 6);
+                batch.vertex_count += 4;
+                batch.index_count += 6;
+                frame.sprite_count++;
+            }
+
         public:
             render_system()
             {
@@ -19,31 +174,130 @@ namespace engine::systems
                 require_component<components::sprite_component>();
             }
 
-            void update(SDL_Renderer* renderer)
+            /**
+             * Builds the batches for every visible sprite into a frame. The alpha value (0 to 1) is how far the
+             * current frame is between the previous simulation tick and the latest one, and is used to interpolate
+             * positions and rotations. Without a camera, world units are screen pixels and nothing is culled.
+             */
+            void build(render_frame& frame, const double alpha = 1.0, const components::camera_component* camera = nullptr)
             {
-                for (const ecs::entity entity: get_system_entities())
+                frame.clear();
+                _instances.clear();
+
+                const std::vector<ecs::entity> entities = get_system_entities();
+                if (!camera)
+                {
+                    for (const ecs::entity entity: entities)
+                    {
+                        add_instance(entity, alpha);
+                    }
+                }
+                else
                 {
-                    const components::transform_component transform = entity.get_component<components::transform_component>();
-                    const components::sprite_component sprite = entity.get_component<components::sprite_component>();
+                    if (get_entities_version() != _indexed_version)
+                    {
+                        index_static(entities);
+                    }
 
-                    SDL_Rect src_rect = sprite.src_rect;
-                    SDL_Rect dest_rect = {
-                        static_cast<int>(transform.position.x),
-                        static_cast<int>(transform.position.y),
-                        static_cast<int>(sprite.width * transform.scale.x),
-                        static_cast<int>(sprite.height * transform.scale.y)
-                    };
+                    _visible_static.clear();
+                    _static_grid.query(camera->view, _visible_static);
+                    for (const int index: _visible_static)
+                    {
+                        add_instance(_static_entities[index], alpha);
+                    }
+
+                    for (const ecs::entity entity: entities)
+                    {
+                        const components::sprite_component& sprite = entity.get_component<components::sprite_component>();
+                        if (!sprite.is_static && get_sprite_bounds(entity.get_component<components::transform_component>(), sprite).overlaps(camera->view))
+                        {
+                            add_instance(entity, alpha);
+                        }
+                    }
+                }
+
+                const glm::vec2 view_origin = camera ? camera->view.min : glm::vec2(0.0f, 0.0f);
+                const float zoom = camera ? camera->zoom : 1.0f;
+
+                _queue.clear();
+                for (size_t i = 0; i < _instances.size(); i++)
+                {
+                    const sprite_instance& instance = _instances[i];
+                    const float depth = instance.position.y + instance.size.y;
+                    _queue.push(render_queue::make_key(instance.layer, instance.texture_index, depth, static_cast<uint32_t>(i)), static_cast<int>(i));
+                }
+                _queue.sort();
+
+                for (int i = 0; i < _queue.get_size(); i++)
+                {
+                    const sprite_instance& instance = _instances[_queue.get_item(i)];
+                    if (frame.batches.empty() || frame.batches.back().layer != instance.layer || frame.batches.back().texture != instance.texture)
+                    {
+                        frame.batches.push_back({
+                            instance.layer,
+                            instance.texture,
+                            static_cast<int>(frame.vertices.size()),
+                            0,
+                            static_cast<int>(frame.indices.size()),
+                            0
+                        });
+                    }
+
+                    add_quad(frame, instance, view_origin, zoom);
+                }
+            }
+
+            /**
+             * Draws a built frame and returns the number of draw calls it took. Given clip rectangles, the frame
+             * is drawn once clipped to each of them instead of to the whole screen; they shouldn't overlap, or
+             * translucent sprites get blended twice.
+             */
+            int submit(SDL_Renderer* renderer, const render_frame& frame, const std::vector<SDL_Rect>* clip_rects = nullptr)
+            {
+                const int passes = clip_rects ? static_cast<int>(clip_rects->size()) : 1;
+                for (int pass = 0; pass < passes; pass++)
+                {
+                    if (clip_rects)
+                    {
+                        SDL_RenderSetClipRect(renderer, &(*clip_rects)[pass]);
+                    }
+
+                    for (const sprite_batch& batch: frame.batches)
+                    {
+                        SDL_RenderGeometry(
+                            renderer,
+                            batch.texture,
+                            frame.vertices.data() + batch.first_vertex,
+                            batch.vertex_count,
+                            frame.indices.data() + batch.first_index,
+                            batch.index_count
+                        );
+                    }
+                }
 
-                    SDL_RenderCopyEx(
-                        renderer,
-                        resources::get_texture(sprite.asset_id),
-                        &src_rect,
-                        &dest_rect,
-                        transform.rotation,
-                        NULL,
-                        SDL_FLIP_NONE
-                    );
+                if (clip_rects)
+                {
+                    SDL_RenderSetClipRect(renderer, nullptr);
                 }
+
+                const int draw_calls = static_cast<int>(frame.batches.size()) * passes;
+                _stats.frames++;
+                _stats.draw_calls += draw_calls;
+                _stats.sprites += frame.sprite_count;
+                _stats.last_draw_calls = draw_calls;
+                return draw_calls;
+            }
+
+            // Draws every visible sprite, interpolated by alpha (see build()).
+            void update(SDL_Renderer* renderer, const double alpha = 1.0, const components::camera_component* camera = nullptr)
+            {
+                build(_frame, alpha, camera);
+                submit(renderer, _frame);
+            }
+
+            render_stats get_stats() const
+            {
+                return _stats;
             }
     };
 }
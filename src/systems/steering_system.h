@@ -0,0 +1,175 @@
+#ifndef ENGINE_STEERINGSYSTEM_H
+#define ENGINE_STEERINGSYSTEM_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "../aabb.h"
+#include "../ecs.h"
+#include "../job_system.h"
+#include "../solidity_grid.h"
+#include "../spatial_hash_grid.h"
+#include "../components/rigidbody_component.h"
+#include "../components/steering_component.h"
+#include "../components/transform_component.h"
+
+namespace engine::systems
+{
+    /**
+     * Crowd steering: separation, alignment and cohesion between neighbouring units, plus avoidance of solid tiles.
+     *
+     * Runs after whatever sets each unit's desired velocity (e.g. the flow field system) and before movement.
+     * Units are gathered into contiguous arrays and a spatial hash grid every tick, then steered in chunks across
+     * the job system's threads. Every chunk reads the gathered state and writes only its own slice of the new
+     * velocities, which are applied once every chunk is done, so results don't depend on processing order.
+     */
+    class steering_system: public ecs::system
+    {
+        private:
+            // Units steered per job.
+            static const int CHUNK_SIZE = 64;
+
+            job_system* _jobs = nullptr;
+            const physics::solidity_grid* _tile_grid = nullptr;
+            physics::spatial_hash_grid _grid;
+
+            std::vector<ecs::entity> _entities;
+            std::vector<components::steering_component> _steering;
+            std::vector<glm::vec2> _positions;
+            std::vector<glm::vec2> _velocities;
+            std::vector<glm::vec2> _new_velocities;
+            std::vector<physics::aabb> _boxes;
+
+            static float get_length(const glm::vec2& vector)
+            {
+                return std::sqrt(vector.x * vector.x + vector.y * vector.y);
+            }
+
+            void steer(int begin, int end, float delta_time)
+            {
+                std::vector<int> neighbors;
+                for (int i = begin; i < end; i++)
+                {
+                    const components::steering_component& steering = _steering[i];
+                    const glm::vec2 position = _positions[i];
+                    const glm::vec2 velocity = _velocities[i];
+                    const float radius = steering.neighbor_radius;
+
+                    neighbors.clear();
+                    _grid.query(physics::aabb(position - glm::vec2(radius, radius), position + glm::vec2(radius, radius)), neighbors);
+
+                    glm::vec2 separation(0.0f, 0.0f);
+                    glm::vec2 average_velocity(0.0f, 0.0f);
+                    glm::vec2 average_position(0.0f, 0.0f);
+                    int neighbor_count = 0;
+                    for (const int neighbor: neighbors)
+                    {
+                        const glm::vec2 offset = position - _positions[neighbor];
+                        const float distance = get_length(offset);
+                        if (neighbor == i || distance >= radius)
+                        {
+                            continue;
+                        }
+
+                        // Push apart harder the closer the neighbour is. Units on the same spot are split by ID.
+                        const glm::vec2 away = distance > 0.0f ? offset / distance : glm::vec2(i < neighbor ? -1.0f : 1.0f, 0.0f);
+                        separation += away * (1.0f - distance / radius);
+                        average_velocity += _velocities[neighbor];
+                        average_position += _positions[neighbor];
+                        neighbor_count++;
+                    }
+
+                    glm::vec2 force = separation * steering.separation_weight;
+                    if (neighbor_count > 0)
+                    {
+                        average_velocity /= static_cast<float>(neighbor_count);
+                        average_position /= static_cast<float>(neighbor_count);
+                        force += (average_velocity - velocity) / std::max(steering.max_speed, 1.0f) * steering.alignment_weight;
+                        force += (average_position - position) / radius * steering.cohesion_weight;
+                    }
+
+                    // Turn away from solid tiles in the way, harder the closer they are.
+                    const float speed = get_length(velocity);
+                    const float look_ahead = speed * steering.look_ahead;
+                    physics::raycast_hit hit;
+                    if (_tile_grid && look_ahead > 0.0f && _tile_grid->raycast(position, velocity / speed, look_ahead, hit))
+                    {
+                        force += hit.normal * (1.0f - hit.distance / look_ahead) * steering.avoidance_weight;
+                    }
+
+                    glm::vec2 new_velocity = velocity + force * delta_time;
+                    const float new_speed = get_length(new_velocity);
+                    if (new_speed > steering.max_speed)
+                    {
+                        new_velocity *= steering.max_speed / new_speed;
+                    }
+
+                    _new_velocities[i] = new_velocity;
+                }
+            }
+
+        public:
+            steering_system()
+            {
+                require_component<components::transform_component>();
+                require_component<components::rigidbody_component>();
+                require_component<components::steering_component>();
+            }
+
+            // Without a job system, every unit is steered on the calling thread.
+            void set_job_system(job_system* jobs)
+            {
+                _jobs = jobs;
+            }
+
+            void set_tile_grid(const physics::solidity_grid* tile_grid)
+            {
+                _tile_grid = tile_grid;
+            }
+
+            void update(const double delta_time)
+            {
+                _entities = get_system_entities();
+                const int count = static_cast<int>(_entities.size());
+                _steering.resize(count);
+                _positions.resize(count);
+                _velocities.resize(count);
+                _new_velocities.resize(count);
+                _boxes.resize(count);
+
+                float max_radius = 1.0f;
+                for (int i = 0; i < count; i++)
+                {
+                    _steering[i] = _entities[i].get_component<components::steering_component>();
+                    _positions[i] = _entities[i].get_component<components::transform_component>().position + _steering[i].anchor;
+                    _velocities[i] = _entities[i].get_component<components::rigidbody_component>().velocity;
+                    _boxes[i] = physics::aabb(_positions[i], _positions[i]);
+                    max_radius = std::max(max_radius, _steering[i].neighbor_radius);
+                }
+
+                // Cells as large as the widest neighbourhood keep every query down to a few cells.
+                _grid.set_cell_size(max_radius);
+                _grid.build(_boxes);
+
+                const float step = static_cast<float>(delta_time);
+                if (_jobs)
+                {
+                    _jobs->parallel_for(count, CHUNK_SIZE, [this, step](int begin, int end)
+                    {
+                        steer(begin, end, step);
+                    });
+                }
+                else
+                {
+                    steer(0, count, step);
+                }
+
+                for (int i = 0; i < count; i++)
+                {
+                    _entities[i].get_component<components::rigidbody_component>().velocity = _new_velocities[i];
+                }
+            }
+    };
+}
+
+#endif
@@ -0,0 +1,222 @@
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <SDL2/SDL.h>
+#include "logger.h"
+#include "resources.h"
+#include "tilemap.h"
+
+engine::tilemap::tilemap()
+{
+    _width = 0;
+    _height = 0;
+    _tile_size = 0;
+    _tileset = resources::INVALID_TEXTURE;
+    _tileset_columns = 1;
+    _chunks_x = 0;
+    _chunks_y = 0;
+}
+
+engine::tilemap::~tilemap()
+{
+    clear();
+}
+
+// Resizes the map to width x height tiles, all empty. Tile indices refer to tileset cells in row major order.
+void engine::tilemap::resize(int width, int height, int tile_size, const std::string& tileset_id, int tileset_columns)
+{
+    clear();
+
+    _width = width;
+    _height = height;
+    _tile_size = tile_size;
+    _tileset = resources::get_texture_handle(tileset_id);
+    _tileset_columns = std::max(tileset_columns, 1);
+    _chunks_x = (width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    _chunks_y = (height + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+    _tiles.assign(width * height, -1);
+    _chunks.resize(_chunks_x * _chunks_y);
+}
+
+// Empties the map and frees every chunk texture.
+void engine::tilemap::clear()
+{
+    for (chunk& current: _chunks)
+    {
+        if (current.texture)
+        {
+            SDL_DestroyTexture(current.texture);
+        }
+    }
+
+    _chunks.clear();
+    _tiles.clear();
+    _width = 0;
+    _height = 0;
+    _chunks_x = 0;
+    _chunks_y = 0;
+}
+
+int engine::tilemap::get_width() const
+{
+    return _width;
+}
+
+int engine::tilemap::get_height() const
+{
+    return _height;
+}
+
+int engine::tilemap::get_tile_size() const
+{
+    return _tile_size;
+}
+
+// Tileset index of a tile, or -1 if it's empty or outside the map.
+int engine::tilemap::get_tile(int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= _width || y >= _height)
+    {
+        return -1;
+    }
+
+    return _tiles[y * _width + x];
+}
+
+void engine::tilemap::set_tile(int x, int y, int tile_index)
+{
+    if (x < 0 || y < 0 || x >= _width || y >= _height || _tiles[y * _width + x] == tile_index)
+    {
+        return;
+    }
+
+    _tiles[y * _width + x] = tile_index;
+    _chunks[(y / CHUNK_SIZE) * _chunks_x + x / CHUNK_SIZE].is_dirty = true;
+}
+
+// Flags every chunk for baking, e.g. after the renderer lost the contents of its target textures.
+void engine::tilemap::mark_all_dirty()
+{
+    for (chunk& current: _chunks)
+    {
+        current.is_dirty = true;
+    }
+}
+
+void engine::tilemap::bake_chunk(SDL_Renderer* renderer, int chunk_x, int chunk_y)
+{
+    chunk& current = _chunks[chunk_y * _chunks_x + chunk_x];
+    current.is_dirty = false;
+
+    const int first_x = chunk_x * CHUNK_SIZE;
+    const int first_y = chunk_y * CHUNK_SIZE;
+    const int columns = std::min(CHUNK_SIZE, _width - first_x);
+    const int rows = std::min(CHUNK_SIZE, _height - first_y);
+
+    if (!current.texture)
+    {
+        current.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_TARGET, columns * _tile_size, rows * _tile_size);
+        if (!current.texture)
+        {
+            logger::error("Failed to create tilemap chunk texture.");
+            return;
+        }
+
+        // Empty tiles are left transparent.
+        SDL_SetTextureBlendMode(current.texture, SDL_BLENDMODE_BLEND);
+    }
+
+    const resources::texture_region& tileset = resources::get_texture_region(_tileset);
+    SDL_Texture* previous_target = SDL_GetRenderTarget(renderer);
+    SDL_SetRenderTarget(renderer, current.texture);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+
+    for (int y = 0; y < rows; y++)
+    {
+        for (int x = 0; x < columns; x++)
+        {
+            const int tile_index = _tiles[(first_y + y) * _width + first_x + x];
+            if (tile_index < 0)
+            {
+                continue;
+            }
+
+            const SDL_Rect src_rect = {
+                tileset.rect.x + (tile_index % _tileset_columns) * _tile_size,
+                tileset.rect.y + (tile_index / _tileset_columns) * _tile_size,
+                _tile_size,
+                _tile_size
+            };
+            const SDL_Rect dest_rect = { x * _tile_size, y * _tile_size, _tile_size, _tile_size };
+            SDL_RenderCopy(renderer, tileset.texture, &src_rect, &dest_rect);
+        }
+    }
+
+    SDL_SetRenderTarget(renderer, previous_target);
+}
+
+// Bakes every flagged chunk and returns how many were baked.
+int engine::tilemap::bake_dirty(SDL_Renderer* renderer)
+{
+    int baked = 0;
+    for (int chunk_y = 0; chunk_y < _chunks_y; chunk_y++)
+    {
+        for (int chunk_x = 0; chunk_x < _chunks_x; chunk_x++)
+        {
+            if (_chunks[chunk_y * _chunks_x + chunk_x].is_dirty)
+            {
+                bake_chunk(renderer, chunk_x, chunk_y);
+                baked++;
+            }
+        }
+    }
+
+    return baked;
+}
+
+/**
+ * Draws the chunks overlapping a world space view, relative to the view and scaled by the zoom.
+ * Returns the number of chunks drawn.
+ */
+int engine::tilemap::render(SDL_Renderer* renderer, const physics::aabb& view, float zoom) const
+{
+    if (_chunks.empty())
+    {
+        return 0;
+    }
+
+    const float chunk_size = static_cast<float>(CHUNK_SIZE * _tile_size);
+    const int first_x = std::max(static_cast<int>(std::floor(view.min.x / chunk_size)), 0);
+    const int first_y = std::max(static_cast<int>(std::floor(view.min.y / chunk_size)), 0);
+    const int last_x = std::min(static_cast<int>(std::floor(view.max.x / chunk_size)), _chunks_x - 1);
+    const int last_y = std::min(static_cast<int>(std::floor(view.max.y / chunk_size)), _chunks_y - 1);
+
+    int drawn = 0;
+    for (int chunk_y = first_y; chunk_y <= last_y; chunk_y++)
+    {
+        for (int chunk_x = first_x; chunk_x <= last_x; chunk_x++)
+        {
+            const chunk& current = _chunks[chunk_y * _chunks_x + chunk_x];
+            if (!current.texture)
+            {
+                continue;
+            }
+
+            const int columns = std::min(CHUNK_SIZE, _width - chunk_x * CHUNK_SIZE);
+            const int rows = std::min(CHUNK_SIZE, _height - chunk_y * CHUNK_SIZE);
+            const SDL_FRect dest_rect = {
+                (chunk_x * chunk_size - view.min.x) * zoom,
+                (chunk_y * chunk_size - view.min.y) * zoom,
+                columns * _tile_size * zoom,
+                rows * _tile_size * zoom
+            };
+            SDL_RenderCopyF(renderer, current.texture, NULL, &dest_rect);
+            drawn++;
+        }
+    }
+
+    return drawn;
+}
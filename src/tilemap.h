@@ -0,0 +1,68 @@
+#ifndef ENGINE_TILEMAP_H
+#define ENGINE_TILEMAP_H
+
+#include <string>
+#include <vector>
+#include <SDL2/SDL.h>
+#include <glm/vec2.hpp>
+#include "aabb.h"
+#include "resources.h"
+
+namespace engine
+{
+    /**
+     * Static tile layer drawn from pre-baked chunks.
+     *
+     * The map is split into chunks of CHUNK_SIZE x CHUNK_SIZE tiles. Each chunk is baked once into its own target
+     * texture, and drawing the map is then one copy per chunk in view instead of one per tile. Changing a tile
+     * only flags its chunk, which gets re-baked on the next bake_dirty().
+     */
+    class tilemap
+    {
+        private:
+            struct chunk
+            {
+                SDL_Texture* texture = nullptr;
+                bool is_dirty = true;
+            };
+
+            int _width;
+            int _height;
+            int _tile_size;
+            resources::texture_handle _tileset;
+            int _tileset_columns;
+            int _chunks_x;
+            int _chunks_y;
+
+            std::vector<int> _tiles;
+            std::vector<chunk> _chunks;
+
+            void bake_chunk(SDL_Renderer* renderer, int chunk_x, int chunk_y);
+
+        public:
+            // Width and height of a chunk, in tiles.
+            static const int CHUNK_SIZE = 16;
+
+            tilemap();
+            ~tilemap();
+
+            tilemap(const tilemap&) = delete;
+            tilemap& operator =(const tilemap&) = delete;
+
+            void resize(int width, int height, int tile_size, const std::string& tileset_id, int tileset_columns);
+            void clear();
+
+            int get_width() const;
+            int get_height() const;
+            int get_tile_size() const;
+
+            int get_tile(int x, int y) const;
+            void set_tile(int x, int y, int tile_index);
+
+            void mark_all_dirty();
+            int bake_dirty(SDL_Renderer* renderer);
+            int render(SDL_Renderer* renderer, const physics::aabb& view, float zoom = 1.0f) const;
+    };
+}
+
+#endif